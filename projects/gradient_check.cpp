@@ -0,0 +1,92 @@
+#include "seahorse.hpp"
+
+// Checks Cost::gradient and Cost::hessianProduct against central differences
+// for every potential type and every way the TrajectoryStore can hold the forward sweep
+// Exits with a failure if any relative error is above tolerance
+
+struct Mode {
+    const char* name;
+    TrajectoryStore::Mode mode;
+    size_t budget;
+    bool absorb;
+};
+
+bool check(const char* name, HamiltonianFn& H, const Mode& mode)
+{
+    const int numSteps = 300;
+    const double dt = 0.001;
+    const RVec t = RVec::LinSpaced(numSteps, 0, dt * numSteps);
+
+    Hamiltonian H0 = H(0);
+    SplitStepper stepper = SplitStepper(dt, H, mode.absorb);
+    Cost cost = StateTransfer(stepper, H0[0], H0[1]) + StateTransfer(stepper, H0[1], H0[0]) + 1e-3 * makeRegularisation() + 1e-2 * makeBoundaries(0.2);
+    cost.setGradientMemory(mode.budget, mode.mode);
+
+    const RVec u = RVec(0.3 * sin(30 * t.array()) + 0.1);
+    const RVec v = RVec::Random(numSteps);
+
+    // Directional derivative of the cost along v
+    RVec g;
+    cost.gradient(u, g);
+    const double h = 1e-6;
+    const double fd_g = (cost(u + h * v).cost - cost(u - h * v).cost) / (2 * h);
+    const double g_err = std::abs(g.dot(v) - fd_g) / std::max(std::abs(fd_g), 1e-12);
+
+    // Hessian product against differences of the (checked) gradient
+    RVec Hv, g_plus, g_minus;
+    cost.hessianProduct(u, v, Hv);
+    const double k = 1e-5;
+    cost.gradient(u + k * v, g_plus);
+    cost.gradient(u - k * v, g_minus);
+    const RVec fd_Hv = (g_plus - g_minus) / (2 * k);
+    const double Hv_err = (Hv - fd_Hv).norm() / std::max(fd_Hv.norm(), 1e-12);
+
+    // Custom potentials take V' and V'' by differences so are only good to ~1e-5
+    const bool ok = g_err < 1e-6 && Hv_err < 1e-4;
+    S_LOG(ok ? "pass " : "FAIL ", name, "\t", mode.name, "\tgradient relerr ", g_err, "\tHessian product relerr ", Hv_err);
+    return ok;
+}
+
+int main()
+{
+    SET_RAND_SEED;
+    Timer timer;
+    timer.Start();
+
+    const int dim = 1 << 7;
+    const auto k = sqrt(2);
+    const auto xlim = PI / k / 2 * 4;
+
+    auto hs = HilbertSpace(dim, xlim);
+    const RVec x = hs.x();
+    const auto depth = 1500;
+    const RVec V0 = RVec(depth - 0.5 * depth * (cos(2 * k * x) + 1) * box(x, -PI / k / 2, PI / k / 2));
+
+    HamiltonianFn constant(hs, ConstantPotential(hs, V0));
+    HamiltonianFn amplitude(hs, AmplitudePotential(hs, V0));
+    HamiltonianFn shaken(hs, ShakenPotential(hs, V0));
+    HamiltonianFn custom(hs, Potential([=](double u) { return RVec(V0 * (1 + u * u) + 100 * u * x); }));
+
+    // A budget of 20 states forces recomputation from checkpoints, the reversible store can't absorb
+    const size_t state_bytes = dim * sizeof(std::complex<double>);
+    const std::vector<Mode> modes = {
+        { "stored", TrajectoryStore::Mode::CHECKPOINT, size_t(1) << 28, true },
+        { "checkpointed", TrajectoryStore::Mode::CHECKPOINT, 20 * state_bytes, true },
+        { "reversible", TrajectoryStore::Mode::REVERSIBLE, 0, false },
+    };
+
+    int failures = 0;
+    for (const auto& mode : modes) {
+        failures += !check("constant", constant, mode);
+        failures += !check("amplitude", amplitude, mode);
+        failures += !check("shaken", shaken, mode);
+        failures += !check("custom", custom, mode);
+    }
+
+    timer.Stop();
+    if (failures) {
+        S_FATAL(failures, " derivative checks failed");
+    }
+    S_LOG("All derivative checks passed");
+    return 0;
+}
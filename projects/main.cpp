@@ -37,6 +37,8 @@ int main()
 
     Cost cost = StateTransfer(stepper, gkp0, gkp1) + StateTransfer(stepper, gkp1, gkp0)
          + 1e-5 * makeRegularisation() ;//+ 1e2 * makeBoundaries(PI / k / 2);
+    // Both transfers share the stepper so evolve them together
+    cost.setPropagation(Cost::Propagation::BATCHED);
 
     Stopper stopper = FidStopper(0.99) + IterStopper(10000) + StallStopper(75);
 
@@ -45,35 +47,29 @@ int main()
     j["x"] = x;
     j["t"] = t;
     j["V"] = V;
-    double bestFid = 0;
-    while (bestFid < 0.99) {
+    // The static data is written once, each iteration then only appends its own record
+    Journal journal("test.jsonl", j);
+    // Journal writes happen on a background thread rather than between iterations
+    AsyncSaver asyncSaver(journal.writer());
+    // Independent restarts run concurrently until any of them reaches the target fidelity
+    Ensemble ensemble([&]() {
         // 4.2 freq is about 0.1MHz at Rb or using harmonic oscillator approx we have sqrt(2*depth)*k as our limit
         Basis basis = Basis::TRIG(t, 4.2 * 5, Basis::Amplitude, 10)
                           // Basis basis = Basis::RESONANT(t, H0.eigenvalues(5), 10)
                           .setMaxAmp(PI / k / 2);
+        return std::make_unique<dCRAB>(basis, stopper, cost, asyncSaver.saver());
+    },
+        FidStopper(0.99), 10);
+    EvaluatedControl bestControl = ensemble.optimise();
 
-        dCRAB optimiser = dCRAB(basis, stopper, cost);
-        optimiser.optimise(10);
-
-        if (optimiser.bestControl.fid > bestFid) {
-            bestFid = optimiser.bestControl.fid;
-
-            stepper.reset(gkp0);
-            std::vector<CVec> psis = { stepper.state() };
-            for (auto phase : optimiser.bestControl.control) {
-                stepper.step(phase);
-                psis.push_back(stepper.state());
-            }
-            j["psis"] = psis;
-
-            j["bestControl"] = optimiser.bestControl;
-            S_LOG("Best fidelity: ", std::to_string(bestFid), " at iteration ", std::to_string(optimiser.num_iterations), " in ", timer.Elapsed(), "s");
-        }
-        j["fids"] += optimiser.bestControl.fid;
-        save("test.json", j);
-    }
+    // Stream the optimised trajectory to disk rather than holding every state for the json
+    TrajectoryWriter trajectory("test.traj", dim, dt);
+    trajectory.record(stepper, gkp0, bestControl.control);
+    trajectory.close();
+    S_LOG("Best fidelity: ", std::to_string(bestControl.fid), " after ", ensemble.restarts(), " restarts in ", timer.Elapsed(), "s");
 
     timer.Stop("(Main)");
-    save("test.json", j);
+    asyncSaver.flush();
+    journal.compact("test.json", { { "trajectory", "test.traj" }, { "bestControl", bestControl }, { "restarts", ensemble.restarts() } });
     return 0;
 }
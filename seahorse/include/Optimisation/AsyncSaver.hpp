@@ -0,0 +1,65 @@
+#pragma once
+
+#include "include/Optimisation/Optimiser.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Immutable copy of the state a saver usually wants, taken on the optimiser's thread
+struct OptimiserSnapshot {
+    // Shared between snapshots until the best control changes
+    std::shared_ptr<const EvaluatedControl> bestControl;
+    int num_iterations;
+    int steps_since_improvement;
+    int fpp;
+};
+typedef std::function<void(const OptimiserSnapshot&)> SnapshotFn;
+
+// Runs a saver on a background thread so file I/O doesn't stall the optimiser
+// Snapshots queue up to capacity, after that the oldest waiting snapshot is dropped in favour of the newest
+// so a slow writer sees fewer, more recent snapshots rather than holding the optimiser up
+class AsyncSaver {
+public:
+    AsyncSaver(SnapshotFn writer, size_t capacity = 4);
+    // Writes any queued snapshots before returning
+    ~AsyncSaver();
+    AsyncSaver(const AsyncSaver&) = delete;
+    AsyncSaver& operator=(const AsyncSaver&) = delete;
+
+    // A SaveFn which queues a snapshot, can be shared between optimisers
+    // NB: the AsyncSaver must outlive every optimiser using it
+    SaveFn saver();
+    // Block until every queued snapshot has been written
+    void flush();
+
+    // Snapshots dropped because the writer fell behind
+    int coalesced() const;
+    // Snapshots written
+    int written() const;
+
+private:
+    SnapshotFn writer;
+    size_t capacity;
+
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable drained;
+    std::deque<OptimiserSnapshot> queue;
+    bool writing = false;
+    bool stopping = false;
+    int numCoalesced = 0;
+    int numWritten = 0;
+    // Last control snapshotted, reused while the best control is identical to it
+    // Optimisers sharing the saver interleave so this is compared in full, not just by cost
+    std::shared_ptr<const EvaluatedControl> lastControl;
+
+    std::thread thread;
+
+    void push(const Optimiser& opt);
+    void run();
+};
+
+// Wraps writer in an AsyncSaver owned by the returned SaveFn, the queue is drained once every copy is destroyed
+SaveFn makeAsyncSaver(SnapshotFn writer, size_t capacity = 4);
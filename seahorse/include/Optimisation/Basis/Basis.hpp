@@ -54,6 +54,9 @@ public:
 
     // returns a control vector given a vector of coefficients
     RVec control(RVec coeffs);
+    // chains a gradient with respect to control(coeffs) back to the coefficients
+    // through the basis functions (by central differences) and the max normalisation
+    RVec gradient(RVec coeffs, const RVec& controlGrad);
 
     // the number of basis functions
     int num_basis_vectors();
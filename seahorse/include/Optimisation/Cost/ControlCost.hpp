@@ -2,6 +2,9 @@
 
 #include "src/Physics/Vectors.hpp"
 
+#include <atomic>
+#include <memory>
+
 // Represents a cost component that is only a function of the control
 class ControlCost {
 public:
@@ -11,11 +14,24 @@ public:
 
     ControlCost(std::function<double(const RVec&)> cost)
         : cost(std::move(cost)) {};
+    // With the gradient of cost with respect to each control sample
+    ControlCost(std::function<double(const RVec&)> cost, std::function<RVec(const RVec&)> grad)
+        : cost(std::move(cost))
+        , grad(std::move(grad)) {};
 
     inline double operator()(const RVec& u) const { return this->weight * this->cost(u); };
+    // Falls back on central differences (O(n) cost evaluations) without an analytic gradient,
+    // which dominates a GRAPE or Krotov iteration so the first fallback is reported
+    RVec gradient(const RVec& u) const;
+    // Hessian of the cost times v, by central differences of the gradient along v
+    // This is exact up to rounding for the quadratic penalties below
+    RVec hessianProduct(const RVec& u, const RVec& v) const;
 
 private:
     std::function<double(const RVec&)> cost;
+    std::function<RVec(const RVec&)> grad = nullptr;
+    // Shared between copies (e.g. the batch workers) so the fallback is only reported once
+    std::shared_ptr<std::atomic<bool>> reported = std::make_shared<std::atomic<bool>>(false);
 };
 
 ControlCost operator*(double weight, ControlCost c);
@@ -3,12 +3,45 @@
 #include "include/Optimisation/Cost/ControlCost.hpp"
 #include "include/Optimisation/Cost/EvaluatedControl.hpp"
 #include "include/Optimisation/Cost/StateTransferCost.hpp"
+#include "include/Physics/TrajectoryStore.hpp"
 #include "src/Utils/Logger.hpp"
 
 // Evaluates a control based on the state to state transfers and control penalties
 class Cost {
 public:
+    // How the StateTransfers are propagated when evaluating a control
+    enum class Propagation {
+        // Each transfer evolves with its own stepper in turn
+        SERIAL,
+        // All initial states evolve together through the first transfer's stepper
+        // Every stepper must have the same dynamics, checked when transfers are added
+        BATCHED,
+        // Each transfer evolves with its own stepper on the OpenMP thread pool
+        PARALLEL
+    };
+
     EvaluatedControl operator()(const RVec&);
+    // Evaluate independent controls concurrently, one worker copy of this cost per thread
+    // Results are returned in the same order as the controls
+    std::vector<EvaluatedControl> operator()(const std::vector<RVec>&);
+    // Number of controls the batch evaluation runs concurrently, 1 means it is just a loop
+    int batchSize() const;
+    // Always evaluate in double precision, used to confirm screened evaluations
+    EvaluatedControl refine(const RVec&);
+    // Evaluate along with the gradient of the cost with respect to each control sample
+    // Each transfer is propagated forward then backward through the trajectory store
+    EvaluatedControl gradient(const RVec&, RVec& grad);
+    // Evaluate along with the Hessian of the cost times v, exact for the split step propagator
+    // Each transfer carries tangents along v through its sweeps, costing about two gradients
+    EvaluatedControl hessianProduct(const RVec&, const RVec& v, RVec& Hv);
+    // Returns the change to sample i given the functional derivative dJ/du(t_i) of the cost there
+    typedef std::function<double(int i, double dJ)> SampleUpdateFn;
+    // Krotov style sweep updating u in place: the co-states are propagated back under u, then the states
+    // forward with each sample updated just before it is used, so dJ comes from states already under the new control
+    // All transfers are propagated together through the first transfer's stepper, as for Propagation::BATCHED
+    // Returns the evaluation of the updated control
+    EvaluatedControl sequentialUpdate(RVec& u, const SampleUpdateFn& update);
+    // Forward propagations, with gradient sweeps counted in units of one evolve
     int fpp = 0;
 
     Cost(StateTransfer transfer) { this->transfers.push_back(transfer); };
@@ -28,9 +61,47 @@ public:
         }
 
         transfers.push_back(st);
+        workers.costs.clear();
+        if (propagation == Propagation::BATCHED) {
+            checkSharedStepper();
+        }
     }
 
-    void addControlCost(ControlCost cc) { components.push_back(cc); }
+    void addControlCost(ControlCost cc)
+    {
+        components.push_back(cc);
+        workers.costs.clear();
+    }
+
+    // chainable setter for the propagation mode
+    Cost& setPropagation(Propagation p)
+    {
+        propagation = p;
+        workers.costs.clear();
+        if (propagation == Propagation::BATCHED) {
+            checkSharedStepper();
+        }
+        return *this;
+    }
+
+    // chainable setter to screen controls with single precision propagations
+    // Optimisers re-evaluate in double before accepting a screened control as their best
+    Cost& setScreening(bool screening = true)
+    {
+        this->screening = screening;
+        workers.costs.clear();
+        return *this;
+    }
+
+    // chainable setter for the memory the gradient may use holding states for the backward sweep
+    // Less memory means more recomputation, REVERSIBLE uses none but needs steppers without an absorber
+    Cost& setGradientMemory(size_t bytes, TrajectoryStore::Mode mode = TrajectoryStore::Mode::CHECKPOINT)
+    {
+        store = TrajectoryStore(bytes);
+        store.setMode(mode);
+        workers.costs.clear();
+        return *this;
+    }
 
     Cost operator+(Cost& other);
     Cost operator+(StateTransfer st);
@@ -40,6 +111,26 @@ public:
 private:
     std::vector<StateTransfer> transfers;
     std::vector<ControlCost> components;
+    Propagation propagation = Propagation::SERIAL;
+    bool screening = false;
+    TrajectoryStore store = TrajectoryStore(size_t(1) << 28);
+
+    EvaluatedControl evaluate(const RVec&, Stepper::Precision precision);
+    // Fatal unless every transfer can be propagated by the first transfer's stepper
+    void checkSharedStepper() const;
+
+    // Copies of this cost used by the batch evaluation, each with its own steppers
+    // These are built on first use and never copied so each Cost owns its own
+    struct Workers {
+        std::vector<Cost> costs;
+        Workers() = default;
+        Workers(const Workers&) { }
+        Workers& operator=(const Workers&)
+        {
+            costs.clear();
+            return *this;
+        }
+    } workers;
 };
 
 // self-self
@@ -9,6 +9,8 @@ struct EvaluatedControl {
     double cost;
     double fid;
     double norm;
+    // Evaluated with a single precision propagation so only approximate
+    bool screened = false;
 
     inline bool operator<(const EvaluatedControl& other) const
     {
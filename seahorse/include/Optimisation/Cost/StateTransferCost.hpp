@@ -20,6 +20,9 @@ private:
 
     std::complex<double> pseudofid = 0.0;
 
+    // Score an already evolved final state against psi_t
+    double score(const CVec& psi_f, const RVec& u);
+
 public:
     // NB: This is not a true fidelity as we just average the fidelities of each
     // transfer. But it's good enough for our purposes.
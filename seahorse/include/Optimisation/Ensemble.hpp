@@ -0,0 +1,62 @@
+#pragma once
+
+#include "include/Optimisation/dCRAB.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Runs several independent dCRAB optimisers concurrently, replacing each with a fresh one when it finishes
+// Every member publishes its best control to a shared record and is checked against a global stopper after
+// each iteration, once the global stopper fires every member is halted
+// The global stopper sees the ensemble as a whole: the shared best control, iterations and fpp summed over
+// every member, and member iterations since the shared best last improved
+class Ensemble {
+public:
+    // Builds a fresh optimiser for each restart, called from the worker threads
+    // so anything random (e.g. the basis) should be created inside it
+    typedef std::function<std::unique_ptr<dCRAB>()> Factory;
+
+    // members = 0 uses one member per hardware thread
+    Ensemble(Factory factory, Stopper stopper, int dressings, int members = 0);
+
+    // Run until the global stopper fires, returning the best control found
+    EvaluatedControl optimise();
+
+    // Best control found so far by any member
+    EvaluatedControl bestControl() const;
+    // Number of optimisers that have finished
+    int restarts() const;
+    // Full path propagations summed over every member
+    int fpp() const;
+
+private:
+    Factory factory;
+    Stopper stopper;
+    int dressings;
+    int members;
+
+    // Shared best-so-far record, replaced whole by compare and swap
+    // libstdc++ implements atomic<shared_ptr> with an internal spin lock so this isn't lock-free,
+    // it is touched once per member iteration so the lock is never contended in practice
+    std::atomic<std::shared_ptr<const EvaluatedControl>> best;
+    std::atomic<bool> halt = false;
+    std::atomic<int> finished = 0;
+    std::atomic<int> totalFpp = 0;
+    // The global stopper isn't thread safe
+    std::mutex stopperMutex;
+
+    // Ensemble-wide progress presented to the global stopper as a single optimiser, guarded by stopperMutex
+    class Progress : public Optimiser {
+    public:
+        Progress(Stopper stopper);
+        void init() override { }
+        void optimise() override { }
+        void step() override { }
+    } progress;
+    // Fold a member's latest iteration into progress, given what it had reported before
+    void record(const Optimiser& opt, int& iterations, int& fpp);
+
+    void publish(const EvaluatedControl& candidate);
+    // Keeps restarting optimisers until we halt
+    void run();
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "include/Optimisation/Basis/Basis.hpp"
+#include "include/Optimisation/LBFGS.hpp"
 #include "include/Optimisation/Optimiser.hpp"
 
 /*
@@ -15,17 +17,30 @@ TODO
 series at least
 */
 
+// Quasi Newton (L-BFGS) optimisation of the coefficients of a Basis rather than of each control sample
+// The control gradient from Cost::gradient is chained through Basis::gradient so we keep
+// the low dimensional, bandwidth limited controls of dCRAB with a gradient per two fpp
 class GRAFS : public Optimiser {
 private:
-    RVec control;
+    std::unique_ptr<Basis> basis;
+    // Quasi Newton steps on the coefficients
+    LBFGS lbfgs;
+    // Set once the line search can no longer decrease the cost
+    bool stalled = false;
 
-  public:
-      GRAFS(RVec control, Stopper& stopper, Cost& cost, SaveFn saver);
-      // No Saver
-      GRAFS(RVec control, Stopper &stopper, Cost &cost);
-      
-      void optimise() override;
+    // Cost of the coefficients along with its gradient with respect to them
+    EvaluatedControl evaluate(const RVec& coeffs, RVec& grad);
 
-      void init() override;
-      void step() override;
+public:
+    // Starts from random coefficients of the basis
+    GRAFS(Basis& basis, Stopper& stopper, Cost& cost, SaveFn saver);
+    // No Saver
+    GRAFS(Basis& basis, Stopper& stopper, Cost& cost);
+    // lbfgs calls back into this optimiser's cost
+    GRAFS(const GRAFS&) = delete;
+
+    void optimise() override;
+
+    void init() override;
+    void step() override;
 };
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "include/Optimisation/LBFGS.hpp"
 #include "include/Optimisation/Optimiser.hpp"
+#include "include/Optimisation/TrustRegion.hpp"
 
 /*
 TODO
@@ -19,14 +21,33 @@ TODO
 series at least
 */
 
+// Quasi Newton (L-BFGS) optimisation of each control sample directly
+// The gradient is exact for the split step propagator and costs one forward and one backward propagation
+// Optionally switches to Newton trust region steps near the target, where L-BFGS converges slowly
 class GRAPE : public Optimiser {
 private:
+    // Starting control
     RVec control;
+    // Quasi Newton steps on the control samples
+    LBFGS lbfgs;
+    // Newton steps from exact Hessian products
+    TrustRegion trust;
+    // Fidelity at which we switch from L-BFGS to Newton steps
+    double newtonFid = std::numeric_limits<double>::infinity();
+    bool newton = false;
+    // Set once neither method can decrease the cost
+    bool stalled = false;
 
 public:
     GRAPE(RVec control, Stopper& stopper, Cost& cost, SaveFn saver);
     // No Saver
     GRAPE(RVec control, Stopper& stopper, Cost& cost);
+    // lbfgs calls back into this optimiser's cost
+    GRAPE(const GRAPE&) = delete;
+
+    // chainable setter to switch to Newton steps once the best fidelity reaches fid (0 for always)
+    // Each Newton step solves for the step with up to cg_iterations Hessian products, each about two gradients
+    GRAPE& setNewton(double fid = 0, int cg_iterations = 20);
 
     void optimise() override;
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "include/Optimisation/Optimiser.hpp"
+
+// Krotov's method on each control sample directly
+// Each iteration propagates the co-states back under the current control, then the states forward while each
+// sample is updated in turn by shape(t) / lambda * -dJ/du(t) from the states already under the new control.
+// With lambda large enough every iteration improves the cost, so there is no line search and each iteration
+// costs a fixed two propagations per transfer (plus any recomputation by the trajectory store)
+// NB: all transfers are propagated together through the first transfer's stepper, as for Propagation::BATCHED
+class Krotov : public Optimiser {
+private:
+    // Starting control
+    RVec control;
+    // Control the next sweep starts from
+    EvaluatedControl current;
+    // Inverse step size, problem dependent as dJ/du scales with the potential
+    double lambda = 1e4;
+    // The user's lambda, which lambda relaxes back towards after rejected sweeps
+    double minLambda = 1e4;
+    // Update shape S(t), all ones if empty
+    RVec shape;
+    // Sweeps rejected in a row, after maxRejected (lambda grown by 2^maxRejected) we are at a stationary point
+    int rejected = 0;
+    int maxRejected = 20;
+    // Sweeps accepted in a row, lambda is halved after every relaxAfter of them
+    int accepted = 0;
+    int relaxAfter = 10;
+    // Set once no step size improves the cost
+    bool stalled = false;
+
+public:
+    Krotov(RVec control, Stopper& stopper, Cost& cost, SaveFn saver);
+    // No Saver
+    Krotov(RVec control, Stopper& stopper, Cost& cost);
+
+    // chainable setter for the inverse step size lambda_a
+    // Sweeps that don't improve the cost are discarded and lambda doubled, up to maxRejected times in a row
+    // After relaxAfter accepted sweeps in a row it is halved again, but never below the value set here
+    Krotov& setLambda(double lambda);
+    // chainable setter for the update shape, e.g. a flattop to keep the ends of the control fixed
+    Krotov& setUpdateShape(const RVec& shape);
+
+    void optimise() override;
+
+    void init() override;
+    void step() override;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "include/Optimisation/Cost/EvaluatedControl.hpp"
+#include <deque>
+#include <functional>
+
+// Limited memory BFGS with a strong Wolfe line search over any RVec of parameters
+// Optimisers supply the cost and gradient at a point and call step() once per iteration
+class LBFGS {
+public:
+    // Cost at x along with its gradient
+    typedef std::function<EvaluatedControl(const RVec& x, RVec& grad)> GradientFn;
+    // Costs (no gradients) of several points at once, e.g. through the Cost batch API
+    typedef std::function<std::vector<EvaluatedControl>(const std::vector<RVec>& xs)> BatchFn;
+
+private:
+    // Wolfe conditions
+    static constexpr double c1 = 1e-4;
+    static constexpr double c2 = 0.9;
+    static constexpr int maxLineSearch = 20;
+
+    GradientFn gradientFn;
+    BatchFn batchFn = nullptr;
+    int batchTrials = 4;
+    int memory;
+
+    // Curvature pairs s = x_{k+1} - x_k and y = g_{k+1} - g_k
+    std::deque<RVec> S;
+    std::deque<RVec> Y;
+
+    RVec m_x;
+    RVec m_grad;
+    EvaluatedControl m_current;
+    // Length of the first step, after that the quasi Newton step is tried first
+    double firstStep = 0.1;
+    // No step changes any parameter by more than this
+    // Controls (and the GRAFS amplitude coefficient) are O(1) so big quasi Newton steps could leave the range
+    // the potential is defined over
+    double maxStep = 1.0;
+
+    // A point on the line x + alpha * d
+    struct Trial {
+        double alpha;
+        EvaluatedControl eval;
+        RVec grad;
+        double slope;
+    };
+    Trial evaluate(const RVec& d, double alpha);
+    // The two loop recursion for -H g
+    RVec direction() const;
+    // Returns false if no point with sufficient decrease was found
+    bool lineSearch(const RVec& d, double alpha, Trial& accepted);
+    bool zoom(const RVec& d, Trial lo, Trial hi, const Trial& origin, Trial& accepted);
+
+public:
+    LBFGS(GradientFn gradient, int memory = 10);
+
+    // chainable setter to screen line search step lengths with batched cost evaluations
+    // trials step lengths alpha, alpha / 2, ... are evaluated together before any gradients
+    LBFGS& setBatch(BatchFn batch, int trials = 4);
+    // chainable setter for the largest change in any parameter on the first step
+    LBFGS& setFirstStep(double step);
+    // chainable setter for the largest change in any parameter on any step, 1 by default
+    LBFGS& setMaxStep(double step);
+
+    // Start from x, forgetting any curvature information
+    EvaluatedControl init(const RVec& x);
+    // One quasi Newton step, returns false once the line search can't decrease the cost
+    bool step();
+
+    const RVec& x() const;
+    const RVec& gradient() const;
+    const EvaluatedControl& current() const;
+};
@@ -2,6 +2,7 @@
 
 #include "include/Optimisation/Cost/Cost.hpp"
 #include "include/Optimisation/Stopper/Stopper.hpp"
+#include <atomic>
 
 class Optimiser;
 typedef std::function<void(const Optimiser&)> SaveFn;
@@ -14,9 +15,15 @@ private:
     Cost cost;
     // Saver
     SaveFn saver;
+    // Set by an Ensemble to stop us early
+    const std::atomic<bool>* halt = nullptr;
 
 public:
     friend class dCRAB;
+    friend class GRAPE;
+    friend class GRAFS;
+    friend class Krotov;
+    friend class Ensemble;
 
     EvaluatedControl bestControl {.control=RVec::Zero(0), .cost=std::numeric_limits<double>::infinity(), .fid=0.0, .norm=0.0};
     // Num iterations
@@ -40,4 +47,6 @@ public:
 
 private:
     void updateBest(EvaluatedControl&);
+    // Whether an Ensemble has asked us to stop
+    bool halted() const;
 };
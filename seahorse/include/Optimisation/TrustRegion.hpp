@@ -0,0 +1,59 @@
+#pragma once
+
+#include "include/Optimisation/Cost/EvaluatedControl.hpp"
+#include <functional>
+
+// Newton trust region method over any RVec of parameters, with a truncated (Steihaug) CG inner solve
+// Only Hessian vector products are needed, so the Hessian itself is never formed
+// Optimisers supply the cost, gradient and Hessian products at a point and call step() once per iteration
+class TrustRegion {
+public:
+    // Cost at x along with its gradient
+    typedef std::function<EvaluatedControl(const RVec& x, RVec& grad)> GradientFn;
+    // Hessian of the cost at x times v
+    typedef std::function<void(const RVec& x, const RVec& v, RVec& Hv)> HessianFn;
+
+private:
+    // Steps are accepted once the actual decrease is this fraction of the predicted one
+    static constexpr double eta = 0.1;
+    // Give up once the radius collapses below this
+    static constexpr double minRadius = 1e-10;
+
+    GradientFn gradientFn;
+    HessianFn hessianFn;
+    double m_radius = 0.1;
+    double maxRadius = 1;
+    int maxCG = 20;
+
+    RVec m_x;
+    RVec m_grad;
+    EvaluatedControl m_current;
+    // Hessian products used by the last step
+    int m_products = 0;
+
+    // Approximately minimise g.p + p.Hp / 2 over |p| <= radius, writing the model decrease to predicted
+    RVec steihaug(double& predicted);
+
+public:
+    TrustRegion(GradientFn gradient, HessianFn hessian);
+
+    // chainable setter for the initial and largest trust radius (2-norm of the step)
+    // The latter bounds the change in any one parameter too
+    TrustRegion& setRadius(double initial, double max);
+    // chainable setter for the most Hessian products per CG solve
+    TrustRegion& setCGIterations(int iterations);
+
+    // Start from x keeping the current radius
+    EvaluatedControl init(const RVec& x);
+    // As above from a point whose cost and gradient are already known
+    void init(const RVec& x, const EvaluatedControl& eval, const RVec& grad);
+    // Take one accepted step, shrinking the radius as needed
+    // Returns false once the radius collapses or the gradient vanishes
+    bool step();
+
+    const RVec& x() const;
+    const RVec& gradient() const;
+    const EvaluatedControl& current() const;
+    double radius() const;
+    int products() const;
+};
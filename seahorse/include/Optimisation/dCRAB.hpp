@@ -23,6 +23,9 @@ private:
         }
     };
 
+    // Evaluate all the candidate points of a step up front
+    bool speculative = false;
+
     // Holds the simplex of control coefficients
     std::vector<SimplexPoint> simplex;
 
@@ -43,6 +46,8 @@ private:
     void regenerateBasis();
 
     EvaluatedControl evaluate(RVec coeffs);
+    // Evaluate several independent sets of coefficients concurrently
+    std::vector<EvaluatedControl> evaluate(const std::vector<RVec>& coeffs);
 
 public:
     dCRAB(Basis& basis, Stopper& stopper, Cost& cost, SaveFn saver);
@@ -55,4 +60,8 @@ public:
 
     void init() override;
     void step() override;
+
+    // Evaluate the reflection, expansion and both contraction points of each step concurrently
+    // This uses more fpp but the latency of a step is a single propagation given enough threads
+    dCRAB& setSpeculative(bool speculative = true);
 };
\ No newline at end of file
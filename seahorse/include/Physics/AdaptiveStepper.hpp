@@ -0,0 +1,67 @@
+#pragma once
+
+#include "include/Physics/FFT.hpp"
+#include "include/Physics/Stepper.hpp"
+
+// Strang splitting with step doubling error control
+// Internal steps cover blocks of 2^L control samples, i.e. dt_L = 2^L dt, using the control at the middle of the block
+// Each block is taken as one step of dt_L and two of dt_L/2, their difference estimates the local error of the big step
+// The block size then halves (and retries) if the error is above tol or doubles if it is well below
+// Quiet stretches of the control are covered in a few big steps while fast shakes fall back towards dt
+class AdaptiveStepper : public Stepper {
+private:
+    double m_tol;
+    int m_max_level;
+
+    // Per level L: exp(-i dt_L T / 2) with the 1/N normalisation and the absorber exp(-dt_L imagPot) (empty if unused)
+    std::vector<CVec> m_T_half;
+    std::vector<RVec> m_absorbers;
+    // exp(-i dt T) for fusing runs of steps of dt
+    CVec m_T_full;
+
+    // The level the next block is attempted at
+    int m_level = 0;
+    // Statistics from the last evolve
+    int m_steps = 0;
+    int m_rejections = 0;
+
+    // Scratch states and potential buffer
+    CVec m_coarse;
+    CVec m_fine;
+    RVec m_V_buf;
+    FFT m_fft;
+
+    // psi *= absorber * exp(-i dt V(u))
+    void kick(CVec& psi, double dt, double u, const double* absorber);
+    // A single Strang step of dt_L on psi with the control u
+    void strang(CVec& psi, int level, double u);
+    // count fused steps of dt from control sample i as in SplitStepper
+    void fused(CVec& psi, const RVec& control, int i, int count);
+    // Control at the middle of the block of samples [i, i + 2^level)
+    static double midpoint(const RVec& control, int i, int level);
+
+protected:
+    // Implementing the clone pattern within derived classes
+    virtual Stepper* clone_impl() const override { return new AdaptiveStepper(*this); }
+
+public:
+    // tol is the largest accepted local error (2-norm) per internal step
+    // Blocks are at most 2^max_level control samples long
+    AdaptiveStepper(double dt, HamiltonianFn& H, double tol, int max_level = 6, bool use_imag_pot = true, FFT::Backend backend = FFT::Backend::DEFAULT);
+    AdaptiveStepper();
+
+    // Also compares the tolerance, levels and absorber
+    bool sameDynamics(const Stepper& other) const override;
+
+    // Discard any internal state changed to date
+    void reset(const CVec& psi_0) override;
+
+    // A single step of dt, no error control
+    void step(double u) override;
+    // Adaptive steps over the whole control
+    void evolve(const CVec& psi_0, const RVec& control) override;
+
+    // Accepted internal steps and rejected attempts in the last evolve
+    int steps() const;
+    int rejections() const;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "include/Physics/SplitStepper.hpp"
+
+// Split-step propagation that covers long runs of a constant control with a single Chebyshev expansion
+// exp(-i tau H) = exp(-i E_c tau) sum_k (2 - delta_k0) (-i)^k J_k(dE tau) T_k((H - E_c) / dE)
+// where [E_c - dE, E_c + dE] bounds the spectrum of H = T(p) + V(x, u) from the extrema of T_p and V(u)
+//
+// Runs of at least min_run identical samples are propagated to within tol (i.e. essentially exactly)
+// with about dE tau + O((dE tau)^(1/3)) applications of H, everything else uses the usual fused split-step
+//
+// Each application of H costs two FFTs like a split-step, so a run of m samples is only cheaper than
+// m split-steps when dE dt < 1. Each run's expansion order is compared with its length and runs that
+// would cost more are split-stepped, so for stiff potentials (e.g. V0 = 1500, dt = 1e-3 on 512 points
+// gives dE dt ~ 9) this falls back to the plain split-step
+//
+// Only forward evolution is provided: step covers a single sample, which always needs at least one
+// application of H, so it is the plain split-step as in evolve. evolveBatch evolves each state in turn,
+// gradients, Hessian products, stepping back and the block operations used by Krotov are fatal rather
+// than silently differentiating the split-step
+// A TrajectoryWriter recording step by step therefore sees the split-step trajectory
+class ChebyshevStepper : public SplitStepper {
+private:
+    // Kinetic energy on the FFT grid and the absorbing boundary strength (empty if unused)
+    RVec m_T_p;
+    RVec m_absorb;
+
+    int m_min_run;
+    double m_tol;
+
+    // Per segment (H - E_c) / dE split into its kinetic (with the 1/N FFT normalisation) and potential parts
+    RVec m_T_scaled;
+    RVec m_V_scaled;
+    // Chebyshev recurrence workspace
+    CVec m_phi_prev;
+    CVec m_phi;
+    CVec m_phi_next;
+    CVec m_sum;
+    FFT m_cheb_fft;
+
+    // Statistics from the last evolve
+    int m_segments = 0;
+    int m_applications = 0;
+
+    // out = (H - E_c) / dE in
+    void applyScaledH(const CVec& in, CVec& out);
+    // Bound the spectrum of T + V(u) by [Ec - dE, Ec + dE] from the extrema of each
+    void bounds(const RVec& V, double& Ec, double& dE) const;
+    // Expansion coefficients J_0(a) ... J_K(a) for a = dE tau, truncated once below tol
+    RVec coefficients(double a) const;
+    // Whether a run of this many samples at u takes fewer applications of H than split-steps
+    bool cheaper(double u, int samples) const;
+    // psi = exp(-i tau H(u)) psi
+    void chebyshev(CVec& psi, double u, double tau);
+    // m_psi_f through a constant run with the absorber split symmetrically around it
+    void propagateRun(double u, double tau);
+    // J_0(a) ... J_K(a) by Miller's backward recurrence, which unlike std::cyl_bessel_j is stable for large orders
+    static RVec bessel(double a, int K);
+
+protected:
+    // Implementing the clone pattern within derived classes
+    virtual Stepper* clone_impl() const override { return new ChebyshevStepper(*this); }
+
+public:
+    // Constructor
+    ChebyshevStepper(double dt, HamiltonianFn& H, int min_run = 32, double tol = 1e-12, bool use_imag_pot = true, FFT::Backend backend = FFT::Backend::DEFAULT);
+    ChebyshevStepper();
+
+    bool sameDynamics(const Stepper& other) const override;
+
+    // Split-step between the constant runs, which are each covered in one go
+    void evolve(const CVec& psi_0, const RVec& control) override;
+    // Each state evolved in turn so the runs are covered the same way
+    void evolveBatch(const CMat& psi_0s, const RVec& control) override;
+
+    // Not provided, see above
+    void stepBack(double u) override;
+    CVec overlapGradient(const CVec& psi_0, const CVec& psi_t, const RVec& control, TrajectoryStore& store, std::complex<double>& tau) override;
+    CVec overlapHessianProduct(const CVec& psi_0, const CVec& psi_t, const RVec& control, const RVec& v, TrajectoryStore& store, std::complex<double>& tau, CVec& grad) override;
+    void stepBlock(CMat& psis, double u) override;
+    void adjointStep(CMat& chis, double u) override;
+    void adjointStepBack(CMat& chis, double u) override;
+    std::complex<double> stepDerivative(const CMat& chis, const CMat& psis, double u) override;
+
+    // Constant runs covered by the Chebyshev expansion in the last evolve and the applications of H they took
+    int segments() const;
+    int applications() const;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "include/Physics/FFT.hpp"
+#include "include/Physics/Stepper.hpp"
+
+// Symmetric split-operator compositions of order > 2
+// A step is T(a_0) V(b_0) T(a_1) ... V(b_{m-1}) T(a_m) with each T/V the exact exponential for a fraction of dt
+// Adjacent kinetic parts of consecutive steps are fused as in SplitStepper
+//
+// As in SplitStepper u_i is held over [i dt, (i + 1) dt] so it is treated as the midpoint sample u((i + 1/2) dt),
+// each V(b_j) sees u at its own stage time, interpolated
+// with a local Lagrange polynomial of the method's order so the time dependence doesn't limit the order
+class CompositionStepper : public Stepper {
+protected:
+    // Splitting coefficients as fractions of dt, a has one more entry than b
+    struct Coefficients {
+        std::vector<double> a;
+        std::vector<double> b;
+    };
+
+private:
+    // Absorbing boundary exp(-dt * imagPot) applied once per step at the middle kick, empty if unused
+    RVec imagPot;
+
+    // Splitting coefficients as fractions of dt
+    std::vector<double> m_a;
+    std::vector<double> m_b;
+    // Times of each kick within a step as a fraction of dt
+    std::vector<double> m_c;
+    int m_order;
+
+    // exp(-i a_j dt T) for each j, and exp(-i (a_m + a_0) dt T) joining steps, all with the 1/N normalisation
+    std::vector<CVec> m_T_exps;
+    CVec m_T_join;
+
+    // Buffer for V(u) for shaken and custom potentials
+    RVec m_V_buf;
+    FFT m_fft;
+
+    // psi *= imagPot * exp(-i b dt V(u))
+    void applyPotential(CVec& psi, double u, double b, bool absorb);
+    // The fused loop on m_psi_f
+    void propagate(const RVec& control);
+    // Control at time (i + c) dt from the midpoint samples around it
+    double interpolate(const RVec& control, int i, double c) const;
+
+protected:
+    CompositionStepper(double dt, HamiltonianFn& H, Coefficients coeffs, int order, bool use_imag_pot, FFT::Backend backend);
+    CompositionStepper();
+
+    // Symmetric composition S(z1 h) S(z0 h) S(z1 h) of a symmetric method of the given order, giving order + 2
+    static Coefficients tripleJump(const Coefficients& method, int order);
+
+public:
+    // The order of the method
+    int order() const;
+    // Number of potential kicks (FFT pairs) per step
+    int stages() const;
+
+    // Also compares the splitting coefficients, kinetic propagators and absorber
+    bool sameDynamics(const Stepper& other) const override;
+
+    // Discard any internal state changed to date
+    void reset(const CVec& psi_0) override;
+
+    // A single step has no neighbouring samples so the control is held constant across the stages
+    void step(double u) override;
+    // Fused steps with the control interpolated between samples
+    void evolve(const CVec& psi_0, const RVec& control) override;
+};
+
+// Yoshida's triple jump compositions of Strang splitting, order 4 (3 kicks) or 6 (9 kicks)
+class YoshidaStepper : public CompositionStepper {
+private:
+    static Coefficients coefficients(int order);
+
+protected:
+    virtual Stepper* clone_impl() const override { return new YoshidaStepper(*this); }
+
+public:
+    YoshidaStepper(double dt, HamiltonianFn& H, int order = 4, bool use_imag_pot = true, FFT::Backend backend = FFT::Backend::DEFAULT);
+    YoshidaStepper();
+};
+
+// Blanes and Moan's optimised 6 kick order 4 method (S6 in J. Comput. Appl. Math. 142 (2002) 313)
+// Several times more accurate than the order 4 Yoshida at the same cost per unit error
+class BlanesMoanStepper : public CompositionStepper {
+private:
+    static Coefficients coefficients();
+
+protected:
+    virtual Stepper* clone_impl() const override { return new BlanesMoanStepper(*this); }
+
+public:
+    BlanesMoanStepper(double dt, HamiltonianFn& H, bool use_imag_pot = true, FFT::Backend backend = FFT::Backend::DEFAULT);
+    BlanesMoanStepper();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "src/Physics/Vectors.hpp"
+#include <memory>
+
+// Interface for planned, in-place and unnormalised 1D FFTs of a fixed length
+// Batches are `howmany` signals stored contiguously (i.e. the columns of a CMat)
+class FFTBackend {
+public:
+    virtual ~FFTBackend() {};
+    virtual std::unique_ptr<FFTBackend> clone() const = 0;
+
+    virtual void fwd(std::complex<double>* data, int howmany) = 0;
+    virtual void inv(std::complex<double>* data, int howmany) = 0;
+    // Single precision transforms, planned on first use
+    virtual void fwd(std::complex<float>* data, int howmany) = 0;
+    virtual void inv(std::complex<float>* data, int howmany) = 0;
+};
+
+// Owns a planned backend for a given signal length
+// NB: inv(fwd(psi)) = N * psi, the 1/N normalisation is left to the caller
+class FFT {
+public:
+    enum class Backend {
+        // MKL if we were built with it, otherwise KISS
+        DEFAULT,
+        // Eigen's built-in kissfft
+        KISS,
+        // Intel MKL DFTI
+        MKL
+    };
+
+private:
+    int m_n = 0;
+    std::unique_ptr<FFTBackend> m_backend;
+
+public:
+    // Constructors
+    FFT() {};
+    FFT(int n, Backend backend = Backend::DEFAULT);
+
+    // Plans are not shareable between threads so copies make their own
+    FFT(const FFT& other);
+    FFT& operator=(const FFT& other);
+    FFT(FFT&& other) = default;
+    FFT& operator=(FFT&& other) = default;
+
+    // In-place transforms of a single state or of every column of a block of states
+    void fwd(CVec& psi);
+    void inv(CVec& psi);
+    void fwd(CMat& psis);
+    void inv(CMat& psis);
+    void fwd(CVecf& psi);
+    void inv(CVecf& psi);
+
+    int size() const;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <complex>
+
+// Fused elementwise kernels for the split-step propagators
+// Each is a single sweep over memory with a vectorised sincos when built with AVX2/FMA
+// The absorber may be nullptr in which case it is skipped
+
+// psi[j] *= absorber[j] * exp(-i * scale * V[j])
+void applyPhase(std::complex<double>* psi, const double* V, double scale, const double* absorber, int n);
+
+// out[j] = absorber[j] * exp(-i * scale * V[j])
+void makePhase(std::complex<double>* out, const double* V, double scale, const double* absorber, int n);
+
+// Single precision version of applyPhase, 8 points per sincos
+void applyPhase(std::complex<float>* psi, const float* V, float scale, const float* absorber, int n);
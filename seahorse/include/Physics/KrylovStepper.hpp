@@ -0,0 +1,88 @@
+#pragma once
+
+#include "include/Physics/Stepper.hpp"
+
+#include <libs/eigen/Eigen/SparseCore>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Propagates exp(-i dt H(u)) psi with short Lanczos iterations on the sparse Hamiltonian H(u),
+// by default hs.T() + diag(V(u)) as HamiltonianFn builds it, so the cost scales with its nonzeros
+// and nothing relies on H splitting into diagonal parts in position and momentum space
+// Any other sparse Hermitian H(u) can be supplied with setHamiltonian
+//
+// The subspace grows until the a posteriori error estimate is below tol, if that takes more than
+// max_dim vectors the step is split into smaller substeps instead
+class KrylovStepper : public Stepper {
+public:
+    // Builds the sparse Hamiltonian for a control value
+    typedef std::function<Eigen::SparseMatrix<double>(double u)> MatrixFn;
+
+private:
+    // Injected Hamiltonian, null to use hs.T() + diag(V(u))
+    // Shared between copies so steppers can tell whether they use the same one
+    std::shared_ptr<const MatrixFn> m_H_fn;
+    // H(m_u), only rebuilt when the control changes
+    Eigen::SparseMatrix<double> m_H;
+    double m_u = std::numeric_limits<double>::quiet_NaN();
+    // Without an injected Hamiltonian only the diagonal of H changes with u,
+    // so we keep the diagonal of T and where each diagonal entry sits in m_H's values
+    RVec m_T_diag;
+    std::vector<int> m_diag_index;
+    RVec m_V_buf;
+    // Absorbing boundary exp(-dt * imagPot) applied after each step, empty if unused
+    RVec imagPot;
+
+    double m_tol;
+    int m_max_dim;
+
+    // Workspace reused between steps
+    // Lanczos vectors as columns and the tridiagonal projection of H
+    CMat m_Q;
+    RVec m_alpha;
+    RVec m_beta;
+    CVec m_w;
+    CVec m_start;
+
+    // Substeps per step, carried between steps of an evolve
+    int m_substeps = 1;
+    // Largest subspace used in the last evolve
+    int m_last_dim = 0;
+
+    // w = H q
+    void applyH(const CVec& q, CVec& w) const;
+    // psi = exp(-i tau H) psi returning the subspace dimension used, or 0 (leaving psi untouched) if it would exceed max_dim
+    int lanczos(CVec& psi, double tau);
+    // Set m_H to H(u) unless it already is
+    void updateHamiltonian(double u);
+
+protected:
+    // Implementing the clone pattern within derived classes
+    virtual Stepper* clone_impl() const override { return new KrylovStepper(*this); }
+
+public:
+    // Constructor
+    KrylovStepper(double dt, HamiltonianFn& H, double tol = 1e-10, int max_dim = 30, bool use_imag_pot = true);
+    KrylovStepper();
+
+    // chainable setter replacing the HamiltonianFn's H(u)
+    KrylovStepper& setHamiltonian(MatrixFn H);
+
+    // Also compares tolerances, absorber and whether the same Hamiltonian was injected
+    bool sameDynamics(const Stepper& other) const override;
+
+    // Discard any internal state changed to date
+    void reset(const CVec& psi_0) override;
+
+    // Evolution of state
+    void step(double u) override;
+    void evolve(const CVec& psi_0, const RVec& control) override;
+
+    // Largest Krylov subspace needed in the last evolve
+    int subspaceDim() const;
+    // Substeps per step at the end of the last evolve
+    int substeps() const;
+};
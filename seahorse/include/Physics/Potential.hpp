@@ -5,6 +5,9 @@
 #include "src/Json/nlohmann_json.hpp"
 #include "src/Physics/Vectors.hpp"
 
+#include <functional>
+#include <memory>
+
 // Potentials hold some potential function V(x) defined on real space
 // They have three flavours currently - Constant, Shaken, and AmplitudeModulated
 // Otherwise a custom one can be supplied
@@ -38,7 +41,8 @@ private:
     tk::spline spline;
 
     // Slow fallback to this for custom potentials
-    std::function<RVec(double)> m_Vfn = nullptr;
+    // Shared between copies so a copy of a custom potential can be told apart from a different one
+    std::shared_ptr<const std::function<RVec(double)>> m_Vfn = nullptr;
 
 private:
     RVec AmplitudeModulatedV(double control) const;
@@ -49,6 +53,19 @@ private:
 
 public:
     RVec operator()(double control) const;
+    // dV/du at the control, analytic except for custom potentials which use central differences
+    RVec derivative(double control) const;
+    // d^2V/du^2 at the control, as above
+    RVec secondDerivative(double control) const;
+
+    Type type() const;
+    // The underlying V(x) for non-custom potentials
+    const RVec& V() const;
+    // Shaken potentials only: write V(x - x0) into out without allocating
+    void ShakenV(double x0, RVec& out) const;
+
+    // Same type and V(x), custom potentials are only equal to copies of themselves
+    bool operator==(const Potential& other) const;
 
     // copy constructor
     Potential(const Potential& other);
@@ -57,7 +74,7 @@ public:
     // Custom control methods
     Potential(std::function<RVec(double)> V)
         : m_type(Type::CUSTOM)
-        , m_Vfn(V) {};
+        , m_Vfn(std::make_shared<const std::function<RVec(double)>>(std::move(V))) {};
     // Specific control methods
     Potential(const RVec& x, const RVec& V, Type type);
 };
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "include/Physics/Potential.hpp"
+#include <mutex>
+
+// Tabulates the diagonal potential propagator imagPot * exp(-i dt V(u)) on a uniform grid of controls in [umin, umax]
+// Controls in between are linearly interpolated between the neighbouring entries
+// Nodes are doubled until the interpolation error per step is below tol (or we hit max_bytes)
+class PropagatorTable {
+private:
+    const double m_umin;
+    const double m_umax;
+    const double m_tol;
+    const size_t m_max_bytes;
+
+    // One propagator per column
+    CMat m_table;
+    double m_du = 0;
+    // Max elementwise interpolation error found at the interval midpoints
+    double m_error = 0;
+
+    std::once_flag m_built;
+
+    // Find the interval and interpolation weight for u
+    void locate(double u, int& j, double& w) const;
+
+public:
+    PropagatorTable(double umin, double umax, double tol, size_t max_bytes = size_t(1) << 30);
+
+    // Build the table on first use, safe to call from several threads sharing it
+    void build(const Potential& V, double dt, const RVec& imagPot);
+
+    bool contains(double u) const;
+    // psi *= P(u)
+    void apply(CVec& psi, double u) const;
+    // out = P(u)
+    void interpolate(double u, CVec& out) const;
+
+    // Number of tabulated controls
+    int size() const;
+    size_t bytes() const;
+    // Max elementwise interpolation error of a single step
+    double error() const;
+};
@@ -59,6 +59,12 @@ public:
     double operator()(double x) const;
     // evaluates at evenly translated (by x0) points from original x
     RVec resample_shifted(double x0) const;
+    // as above but writes into an existing vector of the right size
+    void resample_shifted(double x0, RVec& out) const;
+    // derivative of resample_shifted with respect to x0
+    void resample_shifted_derivative(double x0, RVec& out) const;
+    // second derivative of resample_shifted with respect to x0
+    void resample_shifted_second_derivative(double x0, RVec& out) const;
 };
 
 namespace internal {
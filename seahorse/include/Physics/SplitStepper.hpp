@@ -1,36 +1,157 @@
 #pragma once
 
+#include "include/Physics/FFT.hpp"
+#include "include/Physics/PropagatorTable.hpp"
 #include "include/Physics/Stepper.hpp"
 #include <iostream>
 
 class SplitStepper : public Stepper {
 private:
-    // V is defined on real space, and is the actual potential
+    // V (the base class m_V) is defined on real space, and is the actual potential
     // T is defined on shifted frequency space and is the kinetic energy operator
-    std::function<RVec(double)> m_V;
+    // The 1/N FFT normalisation is folded into m_T_exp and m_T_exp_2
+    // Absorbing boundary exp(-dt * imagPot), empty if unused
     RVec imagPot;
     CVec m_T_exp;
     CVec m_T_exp_2;
+    // Their conjugates for the adjoint steps
+    CVec m_T_back;
+    CVec m_T_back_2;
 
-    // FFT and buffers
-    Eigen::FFT<double> m_fft;
-    CVec m_mombuf;
+    // Precomputed parts of the potential propagator depending on the Potential::Type
+    // CONSTANT: imagPot * exp(-i dt V)
+    CVec m_V_exp_const;
+    // AMPLITUDE: dt * V
+    RVec m_dtV;
+    // SHAKEN: buffer for V(x - x0)
+    RVec m_V_shaken;
+    // Buffer for V(u) of any type, used by the gradients
+    RVec m_V_u;
+
+    // Co-moving frame for SHAKEN potentials: V stays fixed and the shake is a translation in the kinetic step
+    bool m_co_moving = false;
+    // Momentum grid spacing
+    double m_dp = 0;
+    // Kinetic propagator followed by a translation for batches
+    CVec m_T_shift;
+
+    // Optional interpolated potential propagators, shared between clones
+    std::shared_ptr<PropagatorTable> m_table;
+
+    // Single precision copies of the above for Precision::SINGLE, built on first use
+    CVecf m_T_exp_f;
+    CVecf m_T_exp_2_f;
+    RVecf imagPot_f;
+    CVecf m_V_exp_const_f;
+    RVecf m_dtV_f;
+    // Buffer for V(u) in single precision
+    RVecf m_V_f;
+    // Single precision copy of the state
+    CVecf m_psi_single;
+
+    // In-place FFTs on m_psi_f/m_psis_f
+    FFT m_fft;
+    // The shared potential propagator for batches
+    CVec m_V_exp;
+
+    // Multiply psi (or every column of a batch) by imagPot * exp(-i dt V(u))
+    template <Potential::Type type>
+    void applyPotential(CVec& psi, double u);
+    template <Potential::Type type>
+    void applyPotential(CMat& psis, double u);
+    template <Potential::Type type>
+    void applyPotential(CVecf& psi, double u);
+    // As above using m_table where the control is in range
+    void applyTabulated(CVec& psi, double u);
+    void applyTabulated(CMat& psis, double u);
+    // The kinetic propagators T and T/2 matching the precision of State
+    template <typename State>
+    const auto& kinetic() const;
+    template <typename State>
+    const auto& halfKinetic() const;
+    // The fused T/2 V T V ... V T/2 loop with kick(psi, u) applying the potential
+    template <typename State, typename Kick>
+    void propagate(State& psi, const RVec& control, Kick kick);
+    // Dispatch to the above with the right kick for our potential
+    template <typename State>
+    void propagate(State& psi, const RVec& control);
+
+    // fft, multiply by T_exp, ifft
+    template <typename State>
+    void applyKineticFFT(State& psi, const CVec& T_exp);
+
+    // Multiply by T_exp followed by a translation by a, i.e. T_exp * exp(-i p a)
+    template <typename State>
+    void applyShiftedKinetic(State& psi, const CVec& T_exp, double a);
+    // The fused loop for SHAKEN potentials in the co-moving frame
+    template <typename State>
+    void propagateCoMoving(State& psi, const RVec& control);
 
 protected:
     // Implementing the clone pattern within derived classes
     virtual Stepper* clone_impl() const override { return new SplitStepper(*this); }
 
+    // The fused loop on the current state without resetting it, for derived steppers
+    void propagateState(const RVec& control);
+
+    // V(u) for any potential type
+    const RVec& potential(double u);
+
 public:
     // Constructor
-    SplitStepper(double dt, HamiltonianFn& H, bool use_imag_pot = true);
+    SplitStepper(double dt, HamiltonianFn& H, bool use_imag_pot = true, FFT::Backend backend = FFT::Backend::DEFAULT);
     SplitStepper();
 
+    // Propagate shaken potentials in the frame moving with the lattice
+    // The shake is then an exact translation rather than a spline resample each step
+    // NB: the absorbing boundary moves with the lattice in this frame
+    SplitStepper& setCoMovingFrame(bool co_moving = true);
+
+    // Tabulate the potential propagator for controls in [umin, umax] with interpolation error per step below tol
+    // The table is built on first use and shared between clones, other controls use the exact propagator
+    // NB: this does nothing in the co-moving frame where the potential propagator is already constant
+    SplitStepper& setPropagatorTable(double umin, double umax, double tol, size_t max_bytes = size_t(1) << 30);
+    // nullptr if we have no table
+    const PropagatorTable* propagatorTable() const;
+
+    // Single precision is used by evolve for the standard propagators only
+    // step, evolveBatch, the co-moving frame and propagator tables stay in double
+    void setPrecision(Precision precision) override;
+
+    // Also compares the kinetic propagator, absorber, frame and propagator table
+    bool sameDynamics(const Stepper& other) const override;
+
     // Discard any internal state changed to date
     void reset(const CVec& psi_0) override;
 
     // Evolution of state
     void step(double u) override;
+    // H is real so step(u)^-1 = conj step(u) conj, in any of the modes above
+    // NB: the absorbing boundary can't be undone so this needs use_imag_pot = false
+    void stepBack(double u) override;
     // Optimised steps but can't provide intermediate step wavefunctions
     // This combines T/2 ifft fft T/2 between steps to save computation.
     void evolve(const CVec& psi_0, const RVec& control) override;
-};
\ No newline at end of file
+    // As evolve but for a block of states, exp(-i dt V(u)) is only calculated once per step
+    void evolveBatch(const CMat& psi_0s, const RVec& control) override;
+
+    // Exact gradient of the split step propagator: with S_i = K A P(u_i) K (K = T/2, A the absorber)
+    // d overlap / du_i = <chi_{i+1}| K A (-i dt V'(u_i)) P(u_i) K |psi_i> with chi the co-state propagated back from psi_t
+    // NB: differentiates the lab frame propagator, the co-moving frame and tables agree to their own accuracy
+    // States are swept as xi = K psi and co-states as zeta = K^dagger chi so the K K between steps fuse into T,
+    // then each step of either sweep is one FFT pair as in evolve
+    CVec overlapGradient(const CVec& psi_0, const CVec& psi_t, const RVec& control, TrajectoryStore& store, std::complex<double>& tau) override;
+    // Exact Hessian product by forward over reverse differentiation of the above
+    // The forward sweep carries the tangent D psi_{i+1} = S_i D psi_i + v_i S'_i psi_i alongside each state
+    // and the backward sweep the tangent of the co-state, so this costs about twice overlapGradient
+    CVec overlapHessianProduct(const CVec& psi_0, const CVec& psi_t, const RVec& control, const RVec& v, TrajectoryStore& store, std::complex<double>& tau, CVec& grad) override;
+
+    // Block steps with the same lab frame propagator as the gradients, on blocks of K psi and K^dagger chi
+    void enterBlock(CMat& psis, bool adjoint) override;
+    void leaveBlock(CMat& psis, bool adjoint) override;
+    void stepBlock(CMat& xis, double u) override;
+    void adjointStep(CMat& zetas, double u) override;
+    // S^-dagger = S without the absorber, so this needs use_imag_pot = false
+    void adjointStepBack(CMat& zetas, double u) override;
+    std::complex<double> stepDerivative(const CMat& zetas, const CMat& xis, double u) override;
+};
@@ -5,10 +5,18 @@
 #include "include/Physics/Hamiltonian.hpp"
 
 #include <libs/eigen/Eigen/Core>
-#include <libs/eigen/unsupported/Eigen/FFT>
+
+class TrajectoryStore;
 
 // General class to evolve wavefunctions: either by a single `step(u)` or multiple `evolve(control)`.
 class Stepper {
+public:
+    // Floating point precision used by evolve
+    enum class Precision {
+        DOUBLE,
+        // Roughly half the memory traffic, for cheap screening of controls
+        SINGLE
+    };
 
 protected:
     // Implementing the clone pattern within derived classes
@@ -16,6 +24,17 @@ protected:
     double m_dt = 0;
     double m_dx = 0;
     CVec m_psi_f; // current state
+    CMat m_psis_f; // current block of states (one per column) from evolveBatch
+    Precision m_precision = Precision::DOUBLE;
+    // The potential V(x, u), shared between clones
+    std::shared_ptr<const Potential> m_V;
+
+    // Strength of the imaginary potential absorbing the wavefunction in the outer 1/8ths of the domain
+    // Steppers apply exp(-tau * absorber) over a time tau
+    static RVec absorber(const HilbertSpace& hs);
+    // Equal sizes and values, e.g. for comparing optional (empty) absorbers
+    template <typename Vec>
+    static bool same(const Vec& a, const Vec& b) { return a.size() == b.size() && a == b; }
 
 public:
     // Constructor
@@ -31,9 +50,47 @@ public:
 
     // Evolve by a step or a number of steps
     virtual void step(double u) = 0;
+    // Exactly undo step(u), only available for unitary steppers
+    virtual void stepBack(double u);
     virtual void evolve(const CVec& psi_0, const RVec& control) = 0;
+    // Evolve each column of psi_0s under the same control
+    // Defaults to evolving the columns one at a time
+    virtual void evolveBatch(const CMat& psi_0s, const RVec& control);
+
+    // Whether other propagates states exactly as we do, so a block of states can go through either one
+    // Compares the stepper type, dt, grid and potential, derived steppers add their own settings
+    virtual bool sameDynamics(const Stepper& other) const;
+
+    // Steppers without a single precision implementation ignore this and stay in double
+    virtual void setPrecision(Precision precision);
+
+    // Gradient of overlap(psi_t, U(control) psi_0) with respect to each control sample, writing the overlap to tau
+    // The states are revisited backwards through store, so its budget bounds the memory used
+    // Afterwards state() is the final state U(control) psi_0
+    virtual CVec overlapGradient(const CVec& psi_0, const CVec& psi_t, const RVec& control, TrajectoryStore& store, std::complex<double>& tau);
+    // Derivative of the above gradient along the control direction v, i.e. the overlap's Hessian times v
+    // Also writes the gradient itself to grad and the overlap to tau
+    virtual CVec overlapHessianProduct(const CVec& psi_0, const CVec& psi_t, const RVec& control, const RVec& v, TrajectoryStore& store, std::complex<double>& tau, CVec& grad);
+
+    // Single steps S(u) on blocks of states (columns) given explicitly, for sequential (Krotov) updates
+    // Blocks are held in the stepper's own representation between enterBlock and leaveBlock,
+    // so consecutive steps can share work; adjoint selects the co-state representation
+    virtual void enterBlock(CMat& psis, bool adjoint);
+    virtual void leaveBlock(CMat& psis, bool adjoint);
+    // psis <- S(u) psis
+    virtual void stepBlock(CMat& psis, double u);
+    // chis <- S(u)^dagger chis, propagating co-states back a step
+    virtual void adjointStep(CMat& chis, double u);
+    // Undo adjointStep
+    virtual void adjointStepBack(CMat& chis, double u);
+    // Sum over columns of <chi_k| dS/du |psi_k>
+    virtual std::complex<double> stepDerivative(const CMat& chis, const CMat& psis, double u);
+    Precision precision() const;
 
+    // Set the current state as is (no normalisation) e.g. to resume from a checkpoint
+    void setState(const CVec& psi);
     CVec state() const;
+    CMat states() const;
     double dt() const;
     double dx() const;
 };
\ No newline at end of file
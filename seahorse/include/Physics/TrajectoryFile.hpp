@@ -0,0 +1,92 @@
+#pragma once
+
+#include "include/Physics/Stepper.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary trajectory files: a 64 byte header followed by the stored states back to back
+// States are stored as interleaved (re, im) pairs of the chosen format so a reader can map them directly
+enum class TrajectoryFormat : uint32_t {
+    DOUBLE,
+    SINGLE,
+    // IEEE half precision, about 3 significant figures which is plenty for plotting
+    HALF
+};
+
+struct TrajectoryHeader {
+    char magic[8];
+    uint32_t version;
+    TrajectoryFormat format;
+    uint64_t dim;
+    uint64_t count; // states written so far, updated at every flush
+    uint64_t stride; // steps between stored states
+    double dt; // time between stored states
+    char reserved[16];
+};
+static_assert(sizeof(TrajectoryHeader) == 64, "TrajectoryHeader must keep the states 64 byte aligned");
+
+// Appends states to a trajectory file in chunks so memory use doesn't grow with the number of steps
+class TrajectoryWriter {
+private:
+    std::ofstream m_file;
+    TrajectoryHeader m_header;
+    size_t m_state_bytes;
+    std::vector<char> m_chunk;
+    size_t m_chunk_states;
+    size_t m_buffered = 0;
+    uint64_t m_pushed = 0;
+
+    void flush();
+
+public:
+    // dt is the stepper's step, only every stride'th state pushed is kept
+    TrajectoryWriter(const std::string& filename, int dim, double dt, TrajectoryFormat format = TrajectoryFormat::DOUBLE, int stride = 1, size_t chunk_bytes = 1 << 20);
+    ~TrajectoryWriter();
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    // Add the next state of the trajectory
+    void push(const CVec& psi);
+    // Step through the control from psi_0 pushing every state on the way
+    void record(Stepper& stepper, const CVec& psi_0, const RVec& control);
+    // Write out anything buffered, the file is complete afterwards
+    void close();
+
+    // States written (after decimation)
+    int count() const;
+};
+
+// Memory maps a trajectory file, states are read in place without copying the file
+class TrajectoryReader {
+private:
+    const char* m_data = nullptr;
+    size_t m_bytes = 0;
+    TrajectoryHeader m_header;
+    size_t m_state_bytes;
+    int m_count;
+
+    const char* raw(int i) const;
+
+public:
+    TrajectoryReader(const std::string& filename);
+    ~TrajectoryReader();
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    // The i'th stored state converted to a CVec, for any format
+    CVec state(int i) const;
+    // Zero copy views, only for files of the matching format
+    Eigen::Map<const CVec> map(int i) const;
+    Eigen::Map<const CVecf> mapf(int i) const;
+    // All states as the columns of a dim x size matrix (DOUBLE files only)
+    Eigen::Map<const CMat> states() const;
+
+    int size() const;
+    int dim() const;
+    int stride() const;
+    double dt() const;
+    TrajectoryFormat format() const;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "include/Physics/Stepper.hpp"
+
+#include <functional>
+
+// Visits the states of a trajectory in reverse order (e.g. for a backward sweep) without storing all of them
+//
+// CHECKPOINT: binomial checkpointing (Griewank's revolve) within a memory budget
+// With s checkpoints and t forward sweeps up to beta(s, t) = (s + t)! / (s! t!) steps can be reversed,
+// so a few checkpoints cover long trajectories at the cost of recomputing each step about t times
+// REVERSIBLE: constant memory by undoing steps with an inverse step
+class TrajectoryStore {
+public:
+    // Takes state i to state i + 1 (advance) or state i + 1 back to state i (retreat) in place
+    typedef std::function<void(CVec& psi, int i)> StepFn;
+    // Called with state i for i = n, n - 1, ..., 0
+    typedef std::function<void(const CVec& psi, int i)> VisitFn;
+
+    enum class Mode {
+        CHECKPOINT,
+        REVERSIBLE
+    };
+
+private:
+    size_t m_budget;
+    Mode m_mode = Mode::CHECKPOINT;
+
+    // Checkpoint slots, allocated once per reverse and used as a stack
+    std::vector<CVec> m_slots;
+    int m_used = 0;
+    CVec m_psi_0;
+    CVec m_work;
+
+    StepFn m_advance;
+    VisitFn m_visit;
+    int m_advances = 0;
+    int m_retreats = 0;
+
+    // With state a in hand visit states b, b - 1, ..., a + 1 using at most free more checkpoints
+    void reverse(int a, int b, int free, const CVec& psi_a);
+
+public:
+    // budget_bytes bounds the memory held in checkpoints
+    TrajectoryStore(size_t budget_bytes);
+
+    // chainable setter for the mode
+    TrajectoryStore& setMode(Mode mode);
+
+    // Visit states n, ..., 0 of the trajectory from psi_0
+    // retreat is only used (and required) in REVERSIBLE mode
+    void reverse(const CVec& psi_0, int n, StepFn advance, VisitFn visit, StepFn retreat = nullptr);
+
+    // Step a stepper through control[i] (forwards or backwards) from the given state
+    static StepFn advancer(Stepper& stepper, const RVec& control);
+    static StepFn retreater(Stepper& stepper, const RVec& control);
+
+    // Number of steps reversible with s checkpoints and t forward sweeps
+    static double beta(int s, int t);
+
+    // Calls to advance and retreat in the last reverse
+    int advances() const;
+    int retreats() const;
+    // Checkpoints available in the last reverse
+    int checkpoints() const;
+};
@@ -19,5 +19,5 @@ struct randGen {
     double operator()();
 };
 
-// global random generator [0-1]
-extern randGen rands;
\ No newline at end of file
+// global random generator [0-1], one per thread so threads don't share state
+extern thread_local randGen rands;
\ No newline at end of file
@@ -6,19 +6,34 @@
 #include <iostream>
 
 // Be careful with Vectors.hpp - both declaration and definition to allow templated Eigen returns
+#include "include/Optimisation/AsyncSaver.hpp"
 #include "include/Optimisation/Basis/Basis.hpp"
 #include "include/Optimisation/Cost/Cost.hpp"
+#include "include/Optimisation/Ensemble.hpp"
+#include "include/Optimisation/GRAFS.hpp"
+#include "include/Optimisation/GRAPE.hpp"
+#include "include/Optimisation/Krotov.hpp"
+#include "include/Optimisation/LBFGS.hpp"
 #include "include/Optimisation/Optimiser.hpp"
 #include "include/Optimisation/Stopper/Stopper.hpp"
+#include "include/Optimisation/TrustRegion.hpp"
 #include "include/Optimisation/dCRAB.hpp"
+#include "include/Physics/AdaptiveStepper.hpp"
+#include "include/Physics/ChebyshevStepper.hpp"
+#include "include/Physics/CompositionStepper.hpp"
 #include "include/Physics/Hamiltonian.hpp"
 #include "include/Physics/HilbertSpace.hpp"
+#include "include/Physics/KrylovStepper.hpp"
 #include "include/Physics/Potential.hpp"
 #include "include/Physics/Spline.hpp"
 #include "include/Physics/SplitStepper.hpp"
 #include "include/Physics/Stepper.hpp"
+#include "include/Physics/TrajectoryFile.hpp"
+#include "include/Physics/TrajectoryStore.hpp"
 #include "include/Utils/Random.hpp"
 #include "include/Utils/Timer.hpp"
+#include "src/Json/binary.hpp"
+#include "src/Json/journal.hpp"
 #include "src/Json/json.hpp"
 #include "src/Physics/Time.hpp"
 #include "src/Physics/Vectors.hpp"
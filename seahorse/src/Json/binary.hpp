@@ -0,0 +1,327 @@
+// Binary result documents: MessagePack metadata with the large numeric arrays stored as raw aligned blobs
+//
+// Layout: a 64 byte header, the MessagePack metadata, then each blob 64 byte aligned
+// Any float array (or rectangular array of float arrays) of at least BLOB_MIN_SIZE numbers in the document
+// is replaced in the metadata by {"$blob": {"shape": [rows(, cols)], "offset": bytes}} and stored row major.
+// A CVec is written by to_json as [re, im] pairs so its blob has the memory layout of a CVec.
+
+#pragma once
+
+#include "src/Json/nlohmann_json.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace binary_json {
+using json = nlohmann::json;
+
+// Smaller arrays stay inline in the metadata
+constexpr size_t BLOB_MIN_SIZE = 64;
+constexpr size_t ALIGNMENT = 64;
+constexpr char MAGIC[8] = { 'S', 'H', 'D', 'O', 'C', '\0', '\0', '\0' };
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t blobs;
+    uint64_t meta_bytes; // metadata starts straight after the header
+    uint64_t data_offset; // blob offsets are relative to this
+    uint64_t data_bytes;
+    char reserved[24];
+};
+static_assert(sizeof(Header) == 64);
+
+inline size_t aligned(size_t bytes) { return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+inline bool isFloatArray(const json& j)
+{
+    if (!j.is_array() || j.empty()) {
+        return false;
+    }
+    for (const auto& v : j) {
+        if (!v.is_number_float()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rows (and columns, 0 for 1D) if j is a float vector or a rectangular float matrix
+inline bool blobShape(const json& j, size_t& rows, size_t& cols)
+{
+    if (!j.is_array() || j.empty()) {
+        return false;
+    }
+    rows = j.size();
+    if (isFloatArray(j)) {
+        cols = 0;
+        return rows >= BLOB_MIN_SIZE;
+    }
+    cols = j[0].is_array() ? j[0].size() : 0;
+    if (cols == 0) {
+        return false;
+    }
+    for (const auto& row : j) {
+        if (row.size() != cols || !isFloatArray(row)) {
+            return false;
+        }
+    }
+    return rows * cols >= BLOB_MIN_SIZE;
+}
+
+struct Blob {
+    const json* source;
+    size_t rows, cols, offset;
+};
+
+// Copy of j with the blobs replaced by their descriptions
+inline json strip(const json& j, std::vector<Blob>& blobs, size_t& offset)
+{
+    size_t rows, cols;
+    if (blobShape(j, rows, cols)) {
+        blobs.push_back({ &j, rows, cols, offset });
+        json shape = cols ? json::array({ rows, cols }) : json::array({ rows });
+        json description = { { "$blob", { { "shape", shape }, { "offset", offset } } } };
+        offset += aligned(rows * std::max<size_t>(cols, 1) * sizeof(double));
+        return description;
+    }
+    if (j.is_object()) {
+        json out = json::object();
+        for (auto it = j.begin(); it != j.end(); ++it) {
+            out[it.key()] = strip(it.value(), blobs, offset);
+        }
+        return out;
+    }
+    if (j.is_array()) {
+        json out = json::array();
+        for (const auto& v : j) {
+            out.push_back(strip(v, blobs, offset));
+        }
+        return out;
+    }
+    return j;
+}
+
+inline bool isBlob(const json& j) { return j.is_object() && j.size() == 1 && j.contains("$blob"); }
+} // namespace binary_json
+
+// Write j as a binary document, written to a temporary file first like save()
+inline void saveBinary(const std::string& filename, const nlohmann::json& j)
+{
+    using namespace binary_json;
+    std::vector<Blob> blobs;
+    size_t data_bytes = 0;
+    const std::vector<uint8_t> meta = json::to_msgpack(strip(j, blobs, data_bytes));
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.blobs = blobs.size();
+    header.meta_bytes = meta.size();
+    header.data_offset = aligned(sizeof(Header) + meta.size());
+    header.data_bytes = data_bytes;
+
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream o(tmp_filename, std::ios::binary);
+    if (!o.is_open()) {
+        S_FATAL("Could not open file: ", filename);
+    }
+    const char zeros[ALIGNMENT] = {};
+    o.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    o.write(reinterpret_cast<const char*>(meta.data()), meta.size());
+    o.write(zeros, header.data_offset - sizeof(Header) - meta.size());
+
+    std::vector<double> buffer;
+    for (const auto& blob : blobs) {
+        buffer.clear();
+        if (blob.cols == 0) {
+            for (const auto& v : *blob.source) {
+                buffer.push_back(v.get<double>());
+            }
+        } else {
+            for (const auto& row : *blob.source) {
+                for (const auto& v : row) {
+                    buffer.push_back(v.get<double>());
+                }
+            }
+        }
+        const size_t bytes = buffer.size() * sizeof(double);
+        o.write(reinterpret_cast<const char*>(buffer.data()), bytes);
+        o.write(zeros, aligned(bytes) - bytes);
+    }
+    o.close();
+    std::rename(tmp_filename.c_str(), filename.c_str());
+}
+
+// A memory mapped binary document, blobs are viewed in place as Eigen Maps
+// Blobs are addressed by JSON pointer e.g. "/x" or "/bestControl/control"
+class BinaryDocument {
+public:
+    using RMatRowMajor = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+private:
+    const char* m_data = nullptr;
+    size_t m_bytes = 0;
+    binary_json::Header m_header;
+    nlohmann::json m_meta;
+
+    // The data of a blob description along with its rows and columns (0 for a vector)
+    // Every description is checked against the data section before it is read
+    const double* locate(const nlohmann::json& j, size_t& rows, size_t& cols) const
+    {
+        size_t offset;
+        try {
+            const auto& description = j.at("$blob");
+            const auto& shape = description.at("shape");
+            if (!shape.is_array() || shape.empty() || shape.size() > 2) {
+                S_FATAL("Binary document has a blob with an invalid shape: ", shape.dump());
+            }
+            rows = shape.at(0).get<size_t>();
+            cols = shape.size() > 1 ? shape.at(1).get<size_t>() : 0;
+            offset = description.at("offset").get<size_t>();
+        } catch (const nlohmann::json::exception& e) {
+            S_FATAL("Binary document has a malformed blob description: ", e.what());
+        }
+        // Written as divisions and subtractions so corrupt sizes can't overflow past the checks
+        const size_t width = std::max<size_t>(cols, 1);
+        const size_t available = m_header.data_bytes / sizeof(double);
+        if (offset % sizeof(double) != 0 || offset > m_header.data_bytes || rows > available / width
+            || rows * width * sizeof(double) > m_header.data_bytes - offset) {
+            S_FATAL("Binary document has a blob outside its data (offset ", offset, ", shape ", rows, "x", cols, ", ", m_header.data_bytes, " data bytes)");
+        }
+        return reinterpret_cast<const double*>(m_data + m_header.data_offset + offset);
+    }
+
+    // The blob at pointer along with its rows and columns (0 for a vector)
+    const double* blob(const std::string& pointer, size_t& rows, size_t& cols) const
+    {
+        const auto ptr = nlohmann::json::json_pointer(pointer);
+        if (!m_meta.contains(ptr) || !binary_json::isBlob(m_meta.at(ptr))) {
+            S_FATAL("No binary array stored at ", pointer);
+        }
+        return locate(m_meta.at(ptr), rows, cols);
+    }
+
+    nlohmann::json expand(const nlohmann::json& j) const
+    {
+        if (binary_json::isBlob(j)) {
+            size_t rows, cols;
+            const double* p = locate(j, rows, cols);
+            if (cols == 0) {
+                return nlohmann::json(std::vector<double>(p, p + rows));
+            }
+            nlohmann::json out = nlohmann::json::array();
+            for (size_t r = 0; r < rows; r++) {
+                out.push_back(std::vector<double>(p + r * cols, p + (r + 1) * cols));
+            }
+            return out;
+        }
+        if (j.is_object()) {
+            nlohmann::json out = nlohmann::json::object();
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                out[it.key()] = expand(it.value());
+            }
+            return out;
+        }
+        if (j.is_array()) {
+            nlohmann::json out = nlohmann::json::array();
+            for (const auto& v : j) {
+                out.push_back(expand(v));
+            }
+            return out;
+        }
+        return j;
+    }
+
+public:
+    BinaryDocument(const std::string& filename)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            S_FATAL("Could not open file: ", filename);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            S_FATAL("Could not stat file: ", filename);
+        }
+        m_bytes = st.st_size;
+        void* data = m_bytes >= sizeof(m_header) ? mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (data == MAP_FAILED) {
+            S_FATAL("Could not map file: ", filename);
+        }
+        m_data = static_cast<const char*>(data);
+
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        // The metadata sits between the header and the data, which must fit in the file
+        // Written as subtractions so corrupt sizes can't overflow past the checks
+        if (std::memcmp(m_header.magic, binary_json::MAGIC, sizeof(binary_json::MAGIC)) != 0 || m_header.version != binary_json::VERSION
+            || m_header.data_offset < sizeof(m_header) || m_header.data_offset > m_bytes
+            || m_header.meta_bytes > m_header.data_offset - sizeof(m_header)
+            || m_header.data_bytes > m_bytes - m_header.data_offset) {
+            munmap(const_cast<char*>(m_data), m_bytes);
+            S_FATAL("Not a binary document (or an unsupported version): ", filename);
+        }
+        const auto* meta = reinterpret_cast<const uint8_t*>(m_data + sizeof(m_header));
+        m_meta = nlohmann::json::from_msgpack(meta, meta + m_header.meta_bytes);
+    }
+    ~BinaryDocument()
+    {
+        if (m_data) {
+            munmap(const_cast<char*>(m_data), m_bytes);
+        }
+    }
+    BinaryDocument(const BinaryDocument&) = delete;
+    BinaryDocument& operator=(const BinaryDocument&) = delete;
+
+    // The metadata, with blobs left as their descriptions
+    const nlohmann::json& meta() const { return m_meta; }
+    bool isBlob(const std::string& pointer) const
+    {
+        const auto ptr = nlohmann::json::json_pointer(pointer);
+        return m_meta.contains(ptr) && binary_json::isBlob(m_meta[ptr]);
+    }
+    // The whole document as plain json, copying the blobs back into arrays
+    nlohmann::json document() const { return expand(m_meta); }
+
+    // Zero copy views of the stored arrays
+    Eigen::Map<const RVec> rvec(const std::string& pointer) const
+    {
+        size_t rows, cols;
+        const double* p = blob(pointer, rows, cols);
+        if (cols != 0) {
+            S_FATAL(pointer, " is a matrix not a vector");
+        }
+        return Eigen::Map<const RVec>(p, rows);
+    }
+    Eigen::Map<const CVec> cvec(const std::string& pointer) const
+    {
+        size_t rows, cols;
+        const double* p = blob(pointer, rows, cols);
+        if (cols != 2) {
+            S_FATAL(pointer, " is not a complex vector");
+        }
+        return Eigen::Map<const CVec>(reinterpret_cast<const std::complex<double>*>(p), rows);
+    }
+    Eigen::Map<const RMatRowMajor> rmat(const std::string& pointer) const
+    {
+        size_t rows, cols;
+        const double* p = blob(pointer, rows, cols);
+        return Eigen::Map<const RMatRowMajor>(p, rows, std::max<size_t>(cols, 1));
+    }
+};
+
+// Read a whole binary document back as json (use BinaryDocument to avoid copying the arrays)
+inline nlohmann::json loadBinary(const std::string& filename)
+{
+    return BinaryDocument(filename).document();
+}
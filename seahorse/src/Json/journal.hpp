@@ -0,0 +1,125 @@
+// Append only journal of a run in JSON Lines: the static metadata is written once as the first line,
+// then each record is appended as its own line. An append costs O(record) however much came before it,
+// and compact() joins everything into a single document once the run is done.
+
+#pragma once
+
+#include "include/Optimisation/AsyncSaver.hpp"
+#include "src/Json/binary.hpp"
+#include "src/Json/json.hpp"
+
+#include <mutex>
+
+class Journal {
+private:
+    std::string m_filename;
+    std::ofstream m_file;
+    // Guards the file and counters, appends can come from several saver threads
+    mutable std::mutex m_mutex;
+    size_t m_records = 0;
+    // Controls are only recorded when they beat every earlier record
+    double m_best_cost = std::numeric_limits<double>::infinity();
+
+    void record(const EvaluatedControl& best, int iteration, int fpp)
+    {
+        json entry = {
+            { "iteration", iteration },
+            { "fpp", fpp },
+            { "fid", best.fid },
+            { "cost", best.cost },
+            { "norm", best.norm }
+        };
+        bool improved;
+        {
+            std::lock_guard lock(m_mutex);
+            improved = best.cost < m_best_cost;
+            if (improved) {
+                m_best_cost = best.cost;
+            }
+        }
+        if (improved) {
+            entry["control"] = best.control;
+        }
+        append(entry);
+    }
+
+public:
+    Journal(const std::string& filename, const json& metadata)
+        : m_filename(filename)
+        , m_file(filename, std::ios::trunc)
+    {
+        if (!m_file.is_open()) {
+            S_FATAL("Could not open file: ", filename);
+        }
+        m_file << metadata.dump() << std::endl;
+    }
+
+    // Safe to call from several optimisers at once, flushed so the journal survives a crash
+    void append(const json& record)
+    {
+        std::string line = record.dump();
+        std::lock_guard lock(m_mutex);
+        m_file << line << std::endl;
+        m_records++;
+    }
+
+    // A saver recording the progress of an optimiser every iteration
+    SaveFn saver()
+    {
+        return [this](const Optimiser& opt) { record(opt.bestControl, opt.num_iterations, opt.fpp); };
+    }
+    // The same for snapshots, e.g. to write the journal from an AsyncSaver
+    SnapshotFn writer()
+    {
+        return [this](const OptimiserSnapshot& snapshot) { record(*snapshot.bestControl, snapshot.num_iterations, snapshot.fpp); };
+    }
+
+    size_t records() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_records;
+    }
+
+    // The metadata with every record in order under "records"
+    static json read(const std::string& filename)
+    {
+        std::ifstream in(filename);
+        if (!in.is_open()) {
+            S_FATAL("Could not open file: ", filename);
+        }
+        std::string line;
+        std::getline(in, line);
+        json document = json::parse(line);
+        document["records"] = json::array();
+        while (std::getline(in, line)) {
+            // A run killed mid write can leave a partial last line
+            json record = json::parse(line, nullptr, false);
+            if (record.is_discarded()) {
+                S_ERROR("Skipping a malformed journal record in ", filename);
+                continue;
+            }
+            document["records"].push_back(std::move(record));
+        }
+        return document;
+    }
+
+    // Join the journal into one document along with any final results in extra
+    // Saved with saveBinary if binary, otherwise as json
+    json compact(const std::string& filename, const json& extra = json::object(), bool binary = false)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_file.flush();
+        }
+        json document = read(m_filename);
+        if (!extra.is_null()) {
+            document.update(extra);
+        }
+        if (binary) {
+            saveBinary(filename, document);
+        } else {
+            save(filename, document);
+        }
+        return document;
+    }
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "src/Json/nlohmann_json.hpp"
 #include "src/Physics/Vectors.hpp"
 #include "src/Utils/Logger.hpp"
@@ -64,10 +66,14 @@ void to_json(nlohmann::json& j, const Eigen::Matrix<_Scalar, _Rows, _Cols, _Opti
 }
 
 // CVecs - specialised to avoid .at() calls on a number
+// Filled in place rather than through an intermediate std::vector
 void from_json(const json& j, CVec& v)
 {
-    std::vector<std::complex<double>> v1 = j.get<std::vector<std::complex<double>>>();
-    v = Eigen::Map<CVec, Eigen::Unaligned>(v1.data(), v1.size());
+    v.resize(j.size());
+    for (size_t i = 0; i < j.size(); i++) {
+        const auto& p = j[i];
+        v[i] = { p[0].get<double>(), p[1].get<double>() };
+    }
 }
 
 // RVec/RMats/CMats
@@ -0,0 +1,92 @@
+#include "include/Optimisation/AsyncSaver.hpp"
+
+AsyncSaver::AsyncSaver(SnapshotFn writer, size_t capacity)
+    : writer(writer)
+    , capacity(std::max<size_t>(1, capacity))
+{
+    thread = std::thread(&AsyncSaver::run, this);
+}
+
+AsyncSaver::~AsyncSaver()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    queued.notify_one();
+    thread.join();
+}
+
+void AsyncSaver::push(const Optimiser& opt)
+{
+    const EvaluatedControl& best = opt.bestControl;
+    std::unique_lock lock(mutex);
+    // Only copy the control when it has changed
+    if (!lastControl || lastControl->cost != best.cost || lastControl->fid != best.fid || lastControl->norm != best.norm
+        || lastControl->screened != best.screened || lastControl->control.size() != best.control.size() || lastControl->control != best.control) {
+        lock.unlock();
+        auto control = std::make_shared<const EvaluatedControl>(best);
+        lock.lock();
+        lastControl = control;
+    }
+    if (queue.size() == capacity) {
+        queue.pop_front();
+        numCoalesced++;
+    }
+    queue.push_back({ lastControl, opt.num_iterations, opt.steps_since_improvement, opt.fpp });
+    lock.unlock();
+    queued.notify_one();
+}
+
+void AsyncSaver::run()
+{
+    std::unique_lock lock(mutex);
+    while (true) {
+        queued.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        OptimiserSnapshot snapshot = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+
+        lock.unlock();
+        writer(snapshot);
+        lock.lock();
+
+        writing = false;
+        numWritten++;
+        if (queue.empty()) {
+            drained.notify_all();
+        }
+    }
+}
+
+SaveFn AsyncSaver::saver()
+{
+    return [this](const Optimiser& opt) { push(opt); };
+}
+
+void AsyncSaver::flush()
+{
+    std::unique_lock lock(mutex);
+    drained.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+int AsyncSaver::coalesced() const
+{
+    std::lock_guard lock(mutex);
+    return numCoalesced;
+}
+
+int AsyncSaver::written() const
+{
+    std::lock_guard lock(mutex);
+    return numWritten;
+}
+
+SaveFn makeAsyncSaver(SnapshotFn writer, size_t capacity)
+{
+    auto async = std::make_shared<AsyncSaver>(writer, capacity);
+    return [async](const Optimiser& opt) { async->saver()(opt); };
+}
@@ -88,6 +88,46 @@ RVec Basis::control(RVec coeffs)
     return scale * control;
 }
 
+RVec Basis::gradient(RVec coeffs, const RVec& controlGrad)
+{
+    if (coeffs.size() != num_coeffs()) {
+        S_FATAL("Invalid number of coefficients, expected ", num_coeffs(), " got ", coeffs.size(), " instead");
+    }
+    RVec grad = RVec::Zero(num_coeffs());
+    // the unscaled control s, control = maxAmp * c_0 * s / max|s|
+    RVec control = RVec::Zero(m_t_size);
+    for (size_t i = 0; i < m_basis.size(); i++) {
+        std::vector<double> coeffs_i(coeffs.data() + 1 + i * m_num_coeffs_per_basisFn, coeffs.data() + 1 + (i + 1) * m_num_coeffs_per_basisFn);
+        control += m_basis[i](coeffs_i);
+    }
+    Eigen::Index peak;
+    const double controlMax = control.cwiseAbs().maxCoeff(&peak);
+    if (controlMax == 0.0) {
+        return grad;
+    }
+    const double gs = controlGrad.dot(control);
+    const double sign = control[peak] > 0 ? 1 : -1;
+    grad[0] = m_maxAmp * gs / controlMax;
+
+    // d(s / max|s|) = ds / max|s| - s * sign(s_peak) * ds_peak / max|s|^2
+    const double scale = m_maxAmp * coeffs[0] / controlMax;
+    for (size_t i = 0; i < m_basis.size(); i++) {
+        std::vector<double> coeffs_i(coeffs.data() + 1 + i * m_num_coeffs_per_basisFn, coeffs.data() + 1 + (i + 1) * m_num_coeffs_per_basisFn);
+        for (int j = 0; j < m_num_coeffs_per_basisFn; j++) {
+            const double c = coeffs_i[j];
+            const double h = 1e-6 * std::max(1.0, std::abs(c));
+            coeffs_i[j] = c + h;
+            RVec ds = m_basis[i](coeffs_i);
+            coeffs_i[j] = c - h;
+            ds -= m_basis[i](coeffs_i);
+            coeffs_i[j] = c;
+            ds /= 2 * h;
+            grad[1 + i * m_num_coeffs_per_basisFn + j] = scale * (controlGrad.dot(ds) - gs * sign * ds[peak] / controlMax);
+        }
+    }
+    return grad;
+}
+
 int Basis::num_basis_vectors() { return m_basis.size(); }
 int Basis::num_coeffs() { return 1 + m_num_coeffs_per_basisFn * m_basis.size(); }
 
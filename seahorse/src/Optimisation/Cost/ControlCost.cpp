@@ -1,17 +1,51 @@
 #include "include/Optimisation/Cost/ControlCost.hpp"
+#include "src/Utils/Logger.hpp"
+
+RVec ControlCost::gradient(const RVec& u) const
+{
+    if (grad) {
+        return weight * grad(u);
+    }
+    if (!reported->exchange(true)) {
+        S_ERROR("ControlCost has no analytic gradient, falling back on central differences (", 2 * u.size(), " cost evaluations per gradient)");
+    }
+    RVec g(u.size());
+    RVec v = u;
+    for (int i = 0; i < u.size(); i++) {
+        const double h = 1e-6 * std::max(1.0, std::abs(u[i]));
+        v[i] = u[i] + h;
+        const double plus = cost(v);
+        v[i] = u[i] - h;
+        const double minus = cost(v);
+        v[i] = u[i];
+        g[i] = (plus - minus) / (2 * h);
+    }
+    return weight * g;
+}
+
+RVec ControlCost::hessianProduct(const RVec& u, const RVec& v) const
+{
+    const double vmax = v.cwiseAbs().maxCoeff();
+    if (vmax == 0) {
+        return RVec::Zero(u.size());
+    }
+    const double h = 1e-6 * std::max(1.0, u.cwiseAbs().maxCoeff()) / vmax;
+    return (gradient(u + h * v) - gradient(u - h * v)) / (2 * h);
+}
 
 ControlCost makeRegularisation()
 {
     // We take the mean to make the penalty independent of the control size
-    return ControlCost([=](const RVec& u) {
-        return u.cwiseAbs2().mean();
-    });
+    return ControlCost([=](const RVec& u) { return u.cwiseAbs2().mean(); },
+        [=](const RVec& u) { return RVec(2 * u / u.size()); });
 }
 
 ControlCost makeBoundaries(double minBound, double maxBound)
 {
     // We take the mean to make the penalty independent of the control size
-    return ControlCost([=](const RVec& u) { return ((u.array() - maxBound).cwiseMax(0) + (u.array() - minBound).cwiseMin(0)).cwiseAbs2().mean(); });
+    auto excess = [=](const RVec& u) { return RVec((u.array() - maxBound).cwiseMax(0) + (u.array() - minBound).cwiseMin(0)); };
+    return ControlCost([=](const RVec& u) { return excess(u).cwiseAbs2().mean(); },
+        [=](const RVec& u) { return RVec(2 * excess(u) / u.size()); });
 }
 
 ControlCost makeBoundaries(double bound)
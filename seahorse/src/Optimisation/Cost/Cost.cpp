@@ -1,13 +1,46 @@
 #include "include/Optimisation/Cost/Cost.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-EvaluatedControl Cost::operator()(const RVec& u)
+EvaluatedControl Cost::operator()(const RVec& u) { return evaluate(u, screening ? Stepper::Precision::SINGLE : Stepper::Precision::DOUBLE); }
+EvaluatedControl Cost::refine(const RVec& u) { return evaluate(u, Stepper::Precision::DOUBLE); }
+
+EvaluatedControl Cost::evaluate(const RVec& u, Stepper::Precision precision)
 {
     EvaluatedControl eval = { .control = u, .cost = 0, .fid = 0, .norm = 1 };
+    for (auto& transfer : transfers) {
+        transfer.stepper->setPrecision(precision);
+    }
 
     // Evaluate the cost of each transfer
     std::complex<double> fid = 0.0;
+    if (propagation == Propagation::BATCHED && transfers.size() > 1) {
+        CMat psi_0s(transfers.front().psi_0.size(), transfers.size());
+        for (size_t i = 0; i < transfers.size(); i++) {
+            psi_0s.col(i) = transfers[i].psi_0;
+        }
+        auto& stepper = transfers.front().stepper;
+        stepper->evolveBatch(psi_0s, u);
+        const CMat psi_fs = stepper->states();
+        for (size_t i = 0; i < transfers.size(); i++) {
+            transfers[i].score(psi_fs.col(i), u);
+        }
+        // Batches are always propagated in double
+        precision = Stepper::Precision::DOUBLE;
+    } else if (propagation == Propagation::PARALLEL) {
+        // Every transfer owns its own stepper so they can run independently
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < transfers.size(); i++) {
+            transfers[i](u);
+        }
+    } else {
+        for (auto& transfer : transfers) {
+            transfer(u);
+        }
+    }
+    // Reduce in order so the result doesn't depend on the propagation mode
     for (auto& transfer : transfers) {
-        transfer(u);
         fid += transfer.pseudofid;
         eval.norm = std::min(eval.norm, transfer.eval.norm);
         fpp++;
@@ -15,6 +48,7 @@ EvaluatedControl Cost::operator()(const RVec& u)
     // fidelity is 1/d^2 |sum(pseudofids)|^2; with pseudofids the piecewise product of matrix elements of the transfer and goal operator
     eval.fid = std::norm(fid) / transfers.size() / transfers.size();
     eval.cost = -eval.fid;
+    eval.screened = precision == Stepper::Precision::SINGLE;
 
     // Any control costs we want to add
     for (auto& component : components) {
@@ -25,6 +59,206 @@ EvaluatedControl Cost::operator()(const RVec& u)
     return eval;
 }
 
+int Cost::batchSize() const
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Steps the store took over a trajectory of n steps, in sweeps rounded up
+// Each step of a sweep costs one FFT pair like a step of evolve, so this counts evolves
+static int sweeps(const TrajectoryStore& store, int n)
+{
+    return (store.advances() + store.retreats() + n - 1) / std::max(1, n);
+}
+
+EvaluatedControl Cost::gradient(const RVec& u, RVec& grad)
+{
+    EvaluatedControl eval = { .control = u, .cost = 0, .fid = 0, .norm = 1 };
+    std::complex<double> fid = 0.0;
+    CVec dfid = CVec::Zero(u.size());
+    for (auto& transfer : transfers) {
+        transfer.stepper->setPrecision(Stepper::Precision::DOUBLE);
+        std::complex<double> tau;
+        dfid += transfer.stepper->overlapGradient(transfer.psi_0, transfer.psi_t, u, store, tau);
+        transfer.score(transfer.stepper->state(), u);
+        fid += transfer.pseudofid;
+        eval.norm = std::min(eval.norm, transfer.eval.norm);
+        // The co-state sweep plus however many state sweeps the store needed
+        fpp += 1 + sweeps(store, u.size());
+    }
+    const double d = transfers.size();
+    eval.fid = std::norm(fid) / d / d;
+    eval.cost = -eval.fid;
+    // d|F|^2 = 2 Re(conj(F) dF)
+    grad = -2.0 / d / d * (std::conj(fid) * dfid).real();
+
+    for (auto& component : components) {
+        eval.cost += component(u);
+        grad += component.gradient(u);
+    }
+    return eval;
+}
+
+EvaluatedControl Cost::hessianProduct(const RVec& u, const RVec& v, RVec& Hv)
+{
+    EvaluatedControl eval = { .control = u, .cost = 0, .fid = 0, .norm = 1 };
+    std::complex<double> fid = 0.0;
+    CVec dfid = CVec::Zero(u.size());
+    CVec d2fid = CVec::Zero(u.size());
+    for (auto& transfer : transfers) {
+        transfer.stepper->setPrecision(Stepper::Precision::DOUBLE);
+        std::complex<double> tau;
+        CVec grad;
+        d2fid += transfer.stepper->overlapHessianProduct(transfer.psi_0, transfer.psi_t, u, v, store, tau, grad);
+        dfid += grad;
+        transfer.score(transfer.stepper->state(), u);
+        fid += transfer.pseudofid;
+        eval.norm = std::min(eval.norm, transfer.eval.norm);
+        // Both sweeps carry a tangent so count them twice
+        fpp += 2 * (1 + sweeps(store, u.size()));
+    }
+    const double d = transfers.size();
+    eval.fid = std::norm(fid) / d / d;
+    eval.cost = -eval.fid;
+    // D 2 Re(conj(F) dF) = 2 Re(conj(DF) dF + conj(F) D dF) with DF = dF . v
+    const std::complex<double> Dfid = dfid.cwiseProduct(v.cast<std::complex<double>>()).sum();
+    Hv = -2.0 / d / d * (std::conj(Dfid) * dfid + std::conj(fid) * d2fid).real();
+
+    for (auto& component : components) {
+        eval.cost += component(u);
+        Hv += component.hessianProduct(u, v);
+    }
+    return eval;
+}
+
+void Cost::checkSharedStepper() const
+{
+    if (transfers.empty()) {
+        S_FATAL("Cost has no StateTransfers to propagate");
+    }
+    for (size_t k = 1; k < transfers.size(); k++) {
+        if (!transfers[0].stepper->sameDynamics(*transfers[k].stepper)) {
+            S_FATAL("StateTransfer ", k, " uses a stepper with different dynamics to the first, they cannot be propagated together");
+        }
+    }
+}
+
+EvaluatedControl Cost::sequentialUpdate(RVec& u, const SampleUpdateFn& update)
+{
+    // Every co-state is swept through the first transfer's stepper
+    checkSharedStepper();
+    const int n = u.size();
+    const int K = transfers.size();
+    const int N = transfers.front().psi_0.size();
+    auto& stepper = transfers.front().stepper;
+    stepper->setPrecision(Stepper::Precision::DOUBLE);
+    const RVec old = u;
+
+    // The control costs only see the control so their gradient is taken before the sweep
+    RVec dC = RVec::Zero(n);
+    for (auto& component : components) {
+        dC += component.gradient(old);
+    }
+
+    // The co-states of every transfer are stacked into one state for the trajectory store
+    // Both blocks stay in the stepper's block representation until the sweep is done
+    CMat psis(N, K);
+    CMat chis(N, K);
+    for (int k = 0; k < K; k++) {
+        psis.col(k) = transfers[k].psi_0;
+        chis.col(k) = transfers[k].psi_t.conjugate();
+    }
+    stepper->enterBlock(psis, false);
+    stepper->enterBlock(chis, true);
+    const CVec chi_n = CVec::Map(chis.data(), N * K);
+    std::complex<double> fid = 0.0;
+
+    // Trajectory step j takes chi_{n-j} back to chi_{n-j-1} under the old control
+    auto advance = [&](CVec& state, int j) {
+        chis = CMat::Map(state.data(), N, K);
+        stepper->adjointStep(chis, old[n - j - 1]);
+        state = CVec::Map(chis.data(), N * K);
+    };
+    auto retreat = [&](CVec& state, int j) {
+        chis = CMat::Map(state.data(), N, K);
+        stepper->adjointStepBack(chis, old[n - j - 1]);
+        state = CVec::Map(chis.data(), N * K);
+    };
+    // Visited in the order chi_0, chi_1, ..., chi_n
+    auto visit = [&](const CVec& state, int j) {
+        const int i = n - j;
+        chis = CMat::Map(state.data(), N, K);
+        if (i == 0) {
+            // The overlap under the old control weights the co-states as in the gradient
+            stepper->leaveBlock(chis, true);
+            for (int k = 0; k < K; k++) {
+                fid += chis.col(k).dot(transfers[k].psi_0);
+            }
+            return;
+        }
+        const std::complex<double> dfid = stepper->stepDerivative(chis, psis, old[i - 1]);
+        const double dJ = -2.0 / K / K * (std::conj(fid) * dfid).real() + dC[i - 1];
+        u[i - 1] += update(i - 1, dJ / stepper->dt());
+        stepper->stepBlock(psis, u[i - 1]);
+    };
+    store.reverse(chi_n, n, advance, visit, retreat);
+    stepper->leaveBlock(psis, false);
+    // The forward sweep plus however many co-state sweeps the store needed, for every transfer
+    fpp += K * (1 + sweeps(store, n));
+
+    EvaluatedControl eval = { .control = u, .cost = 0, .fid = 0, .norm = 1 };
+    fid = 0.0;
+    for (int k = 0; k < K; k++) {
+        transfers[k].score(psis.col(k), u);
+        fid += transfers[k].pseudofid;
+        eval.norm = std::min(eval.norm, transfers[k].eval.norm);
+    }
+    eval.fid = std::norm(fid) / K / K;
+    eval.cost = -eval.fid;
+    for (auto& component : components) {
+        eval.cost += component(u);
+    }
+    return eval;
+}
+
+std::vector<EvaluatedControl> Cost::operator()(const std::vector<RVec>& us)
+{
+    std::vector<EvaluatedControl> evals(us.size());
+#ifdef _OPENMP
+    const int threads = std::min<int>(omp_get_max_threads(), us.size());
+    if (threads > 1) {
+        // Each worker evaluates whole controls so we don't want them parallelising internally too
+        while ((int)workers.costs.size() < threads) {
+            workers.costs.push_back(*this);
+            workers.costs.back().fpp = 0;
+            if (propagation == Propagation::PARALLEL) {
+                workers.costs.back().propagation = Propagation::SERIAL;
+            }
+        }
+
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (size_t i = 0; i < us.size(); i++) {
+            evals[i] = workers.costs[omp_get_thread_num()](us[i]);
+        }
+
+        // Account for the worker propagations
+        for (auto& worker : workers.costs) {
+            fpp += worker.fpp;
+            worker.fpp = 0;
+        }
+        return evals;
+    }
+#endif
+    for (size_t i = 0; i < us.size(); i++) {
+        evals[i] = (*this)(us[i]);
+    }
+    return evals;
+}
+
 Cost Cost::operator+(Cost& other)
 {
     for (auto& transfer : other.transfers) {
@@ -34,12 +268,20 @@ Cost Cost::operator+(Cost& other)
         this->components.push_back(std::move(component));
     }
     this->fpp += other.fpp;
+    workers.costs.clear();
+    if (propagation == Propagation::BATCHED) {
+        checkSharedStepper();
+    }
     return *this;
 }
 
 Cost Cost::operator+(StateTransfer st)
 {
     this->transfers.push_back(st);
+    workers.costs.clear();
+    if (propagation == Propagation::BATCHED) {
+        checkSharedStepper();
+    }
     return *this;
 }
 Cost operator+(StateTransfer st, Cost c)
@@ -50,6 +292,7 @@ Cost operator+(StateTransfer st, Cost c)
 Cost Cost::operator+(ControlCost cc)
 {
     this->components.push_back(cc);
+    workers.costs.clear();
     return *this;
 }
 Cost operator+(ControlCost cc, Cost c)
@@ -4,11 +4,16 @@
 double StateTransfer::operator()(const RVec& u)
 {
     stepper->evolve(psi_0, u);
-    this->pseudofid = overlap(psi_t, stepper->state());
+    return score(stepper->state(), u);
+}
+
+double StateTransfer::score(const CVec& psi_f, const RVec& u)
+{
+    this->pseudofid = overlap(psi_t, psi_f);
 
-    double fid = fidelity(psi_t, stepper->state());
+    double fid = fidelity(psi_t, psi_f);
     // We want to maximise the fidelity, so the cost is the negative
-    eval = { .control = u, .cost = -fid, .fid = fid, .norm = stepper->state().norm() };
+    eval = { .control = u, .cost = -fid, .fid = fid, .norm = psi_f.norm() };
 
     return eval.fid;
 }
@@ -0,0 +1,104 @@
+#include "include/Optimisation/Ensemble.hpp"
+#include "src/Utils/Logger.hpp"
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+Ensemble::Ensemble(Factory factory, Stopper stopper, int dressings, int members)
+    : factory(factory)
+    , stopper(stopper)
+    , dressings(dressings)
+    , members(members > 0 ? members : std::max(1u, std::thread::hardware_concurrency()))
+    , progress(stopper)
+{
+    best = std::make_shared<const EvaluatedControl>(EvaluatedControl { .control = RVec::Zero(0), .cost = std::numeric_limits<double>::infinity(), .fid = 0.0, .norm = 0.0 });
+}
+
+void Ensemble::publish(const EvaluatedControl& candidate)
+{
+    auto current = best.load();
+    if (!(candidate < *current)) {
+        return;
+    }
+    auto next = std::make_shared<const EvaluatedControl>(candidate);
+    // If someone else got there first we only replace them if we are still better
+    while (candidate < *current && !best.compare_exchange_weak(current, next)) { }
+}
+
+// The cost is never evaluated, the stopper only reads the counters and best control
+Ensemble::Progress::Progress(Stopper stopper)
+    : Optimiser(stopper, Cost(ControlCost([](const RVec&) { return 0.0; })), nullptr)
+{
+}
+
+void Ensemble::record(const Optimiser& opt, int& iterations, int& fpp)
+{
+    const int steps = opt.num_iterations - iterations;
+    progress.num_iterations += steps;
+    progress.fpp += opt.fpp - fpp;
+    iterations = opt.num_iterations;
+    fpp = opt.fpp;
+
+    if (opt.bestControl < progress.bestControl) {
+        progress.bestControl = opt.bestControl;
+        progress.steps_since_improvement = 0;
+    } else {
+        progress.steps_since_improvement += steps;
+    }
+}
+
+void Ensemble::run()
+{
+#ifdef _OPENMP
+    // Share the OpenMP threads between the members rather than each member using all of them
+    omp_set_num_threads(std::max(1, omp_get_num_procs() / members));
+#endif
+    while (!halt) {
+        std::unique_ptr<dCRAB> optimiser = factory();
+        optimiser->halt = &halt;
+
+        // Wrap the member's saver to publish its progress and check the global stopper
+        SaveFn saver = optimiser->saver;
+        optimiser->saver = [this, saver, iterations = 0, fpp = 0](const Optimiser& opt) mutable {
+            if (saver) {
+                saver(opt);
+            }
+            publish(opt.bestControl);
+            std::lock_guard lock(stopperMutex);
+            record(opt, iterations, fpp);
+            if (!halt && stopper(progress)) {
+                halt = true;
+            }
+        };
+
+        optimiser->optimise(dressings);
+        publish(optimiser->bestControl);
+        totalFpp += optimiser->cost.fpp;
+        finished++;
+    }
+}
+
+EvaluatedControl Ensemble::optimise()
+{
+    S_LOG("Ensemble optimise using ", members, " members");
+    halt = false;
+    progress.num_iterations = 0;
+    progress.steps_since_improvement = 0;
+    progress.fpp = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < members; i++) {
+        threads.emplace_back(&Ensemble::run, this);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    S_LOG("Ensemble finished with {", finished, " restarts, ", totalFpp, " fpps, ", bestControl().fid, " fid}");
+    return bestControl();
+}
+
+EvaluatedControl Ensemble::bestControl() const { return *best.load(); }
+int Ensemble::restarts() const { return finished; }
+int Ensemble::fpp() const { return totalFpp; }
@@ -0,0 +1,86 @@
+#include "include/Optimisation/GRAFS.hpp"
+#include "src/Utils/Logger.hpp"
+
+GRAFS::GRAFS(Basis& basis, Stopper& stopper, Cost& cost, SaveFn saver)
+    : Optimiser(stopper, cost, saver)
+    , basis(std::make_unique<Basis>(basis))
+    , lbfgs([this](const RVec& coeffs, RVec& grad) { return evaluate(coeffs, grad); })
+{
+    // Line search trials are screened together when the cost can run them concurrently
+    if (this->cost.batchSize() > 1) {
+        lbfgs.setBatch([this](const std::vector<RVec>& coeffs) {
+            std::vector<RVec> controls;
+            for (auto& c : coeffs) {
+                controls.push_back(this->basis->control(c));
+            }
+            return this->cost(controls);
+        });
+    }
+    GRAFS::init();
+}
+
+// No saver
+GRAFS::GRAFS(Basis& basis, Stopper& stopper, Cost& cost)
+    : GRAFS(basis, stopper, cost, [](const Optimiser& opt) { S_LOG(opt.num_iterations, "\tfid= ", opt.bestControl.fid, "\tcost= ", opt.bestControl.cost); })
+{
+}
+
+EvaluatedControl GRAFS::evaluate(const RVec& coeffs, RVec& grad)
+{
+    RVec controlGrad;
+    EvaluatedControl eval = cost.gradient(basis->control(coeffs), controlGrad);
+    grad = basis->gradient(coeffs, controlGrad);
+    return eval;
+}
+
+void GRAFS::init()
+{
+    num_iterations = 0;
+    steps_since_improvement = 0;
+    stalled = false;
+
+    EvaluatedControl eval = lbfgs.init(basis->randomCoeffs());
+    updateBest(eval);
+}
+
+void GRAFS::optimise()
+{
+    S_LOG("GRAFS optimise using a basis size of ", basis->num_basis_vectors());
+
+    while (!halted()) {
+        // update our number of full path propagations
+        fpp = cost.fpp;
+
+        // save data from control if we have a saver
+        if (saver) {
+            saver(*this);
+        }
+
+        // break if we satisfy contraints
+        if (stopper(*this)) {
+            break;
+        }
+        if (stalled) {
+            S_LOG("STOPPING: ", "Line search can't decrease the cost");
+            break;
+        }
+
+        step();
+    }
+    S_LOG("GRAFS finished with {", num_iterations, " iters, ", fpp, " fpps, ",
+        bestControl.fid, " fid, ", bestControl.norm, " norm, ",
+        bestControl.cost, " cost}");
+}
+
+void GRAFS::step()
+{
+    num_iterations++;
+    steps_since_improvement++;
+
+    if (!lbfgs.step()) {
+        stalled = true;
+        return;
+    }
+    EvaluatedControl eval = lbfgs.current();
+    updateBest(eval);
+}
@@ -1,2 +1,89 @@
 #include "include/Optimisation/GRAPE.hpp"
 #include "src/Utils/Logger.hpp"
+
+GRAPE::GRAPE(RVec control, Stopper& stopper, Cost& cost, SaveFn saver)
+    : Optimiser(stopper, cost, saver)
+    , control(control)
+    , lbfgs([this](const RVec& u, RVec& grad) { return this->cost.gradient(u, grad); })
+    , trust([this](const RVec& u, RVec& grad) { return this->cost.gradient(u, grad); },
+          [this](const RVec& u, const RVec& v, RVec& Hv) { this->cost.hessianProduct(u, v, Hv); })
+{
+    trust.setRadius(0.1, 1.0);
+    // Line search trials are screened together when the cost can run them concurrently
+    if (this->cost.batchSize() > 1) {
+        lbfgs.setBatch([this](const std::vector<RVec>& us) { return this->cost(us); });
+    }
+    GRAPE::init();
+}
+
+// No saver
+GRAPE::GRAPE(RVec control, Stopper& stopper, Cost& cost)
+    : GRAPE(control, stopper, cost, [](const Optimiser& opt) { S_LOG(opt.num_iterations, "\tfid= ", opt.bestControl.fid, "\tcost= ", opt.bestControl.cost); })
+{
+}
+
+GRAPE& GRAPE::setNewton(double fid, int cg_iterations)
+{
+    newtonFid = fid;
+    trust.setCGIterations(cg_iterations);
+    return *this;
+}
+
+void GRAPE::init()
+{
+    num_iterations = 0;
+    steps_since_improvement = 0;
+    stalled = false;
+    newton = false;
+
+    EvaluatedControl eval = lbfgs.init(control);
+    updateBest(eval);
+}
+
+void GRAPE::optimise()
+{
+    S_LOG("GRAPE optimise using ", control.size(), " control samples");
+
+    while (!halted()) {
+        // update our number of full path propagations
+        fpp = cost.fpp;
+
+        // save data from control if we have a saver
+        if (saver) {
+            saver(*this);
+        }
+
+        // break if we satisfy contraints
+        if (stopper(*this)) {
+            break;
+        }
+        if (stalled) {
+            S_LOG("STOPPING: ", "Can't decrease the cost any further");
+            break;
+        }
+
+        step();
+    }
+    S_LOG("GRAPE finished with {", num_iterations, " iters, ", fpp, " fpps, ",
+        bestControl.fid, " fid, ", bestControl.norm, " norm, ",
+        bestControl.cost, " cost}");
+}
+
+void GRAPE::step()
+{
+    num_iterations++;
+    steps_since_improvement++;
+
+    if (!newton && lbfgs.current().fid >= newtonFid) {
+        S_LOG("Switching to Newton steps at fid ", lbfgs.current().fid);
+        newton = true;
+        trust.init(lbfgs.x(), lbfgs.current(), lbfgs.gradient());
+    }
+
+    if (newton ? !trust.step() : !lbfgs.step()) {
+        stalled = true;
+        return;
+    }
+    EvaluatedControl eval = newton ? trust.current() : lbfgs.current();
+    updateBest(eval);
+}
@@ -0,0 +1,107 @@
+#include "include/Optimisation/Krotov.hpp"
+#include "src/Utils/Logger.hpp"
+
+Krotov::Krotov(RVec control, Stopper& stopper, Cost& cost, SaveFn saver)
+    : Optimiser(stopper, cost, saver)
+    , control(control)
+{
+    Krotov::init();
+}
+
+// No saver
+Krotov::Krotov(RVec control, Stopper& stopper, Cost& cost)
+    : Krotov(control, stopper, cost, [](const Optimiser& opt) { S_LOG(opt.num_iterations, "\tfid= ", opt.bestControl.fid, "\tcost= ", opt.bestControl.cost); })
+{
+}
+
+Krotov& Krotov::setLambda(double lambda)
+{
+    if (lambda <= 0) {
+        S_FATAL("Krotov lambda must be positive, got ", lambda);
+    }
+    this->lambda = lambda;
+    minLambda = lambda;
+    return *this;
+}
+
+Krotov& Krotov::setUpdateShape(const RVec& shape)
+{
+    if (shape.size() != control.size()) {
+        S_FATAL("Update shape has ", shape.size(), " samples but the control has ", control.size());
+    }
+    this->shape = shape;
+    return *this;
+}
+
+void Krotov::init()
+{
+    num_iterations = 0;
+    steps_since_improvement = 0;
+    rejected = 0;
+    accepted = 0;
+    stalled = false;
+
+    // Sweeps are evaluated in double so compare against a double evaluation, not a screened one
+    current = cost.refine(control);
+    updateBest(current);
+}
+
+void Krotov::optimise()
+{
+    S_LOG("Krotov optimise using ", control.size(), " control samples");
+
+    while (!halted()) {
+        // update our number of full path propagations
+        fpp = cost.fpp;
+
+        // save data from control if we have a saver
+        if (saver) {
+            saver(*this);
+        }
+
+        // break if we satisfy contraints
+        if (stopper(*this)) {
+            break;
+        }
+        if (stalled) {
+            S_LOG("STOPPING: ", "Can't decrease the cost any further");
+            break;
+        }
+
+        step();
+    }
+    S_LOG("Krotov finished with {", num_iterations, " iters, ", fpp, " fpps, ",
+        bestControl.fid, " fid, ", bestControl.norm, " norm, ",
+        bestControl.cost, " cost}");
+}
+
+void Krotov::step()
+{
+    num_iterations++;
+    steps_since_improvement++;
+
+    RVec u = current.control;
+    EvaluatedControl eval = cost.sequentialUpdate(u, [this](int i, double dJ) {
+        return -(shape.size() ? shape[i] : 1.0) / lambda * dJ;
+    });
+
+    // Keep the cost monotonic, a smaller step will improve it
+    if (!(eval.cost < current.cost)) {
+        accepted = 0;
+        if (++rejected >= maxRejected) {
+            stalled = true;
+            return;
+        }
+        lambda *= 2;
+        S_LOG("Krotov sweep didn't improve the cost, increasing lambda to ", lambda);
+        return;
+    }
+    rejected = 0;
+    // Grow the step again so one hard sweep doesn't slow every later one
+    if (++accepted >= relaxAfter && lambda > minLambda) {
+        accepted = 0;
+        lambda = std::max(minLambda, lambda / 2);
+    }
+    current = eval;
+    updateBest(eval);
+}
@@ -0,0 +1,205 @@
+#include "include/Optimisation/LBFGS.hpp"
+#include "src/Utils/Logger.hpp"
+
+LBFGS::LBFGS(GradientFn gradient, int memory)
+    : gradientFn(gradient)
+    , memory(memory)
+{
+}
+
+LBFGS& LBFGS::setBatch(BatchFn batch, int trials)
+{
+    batchFn = batch;
+    batchTrials = std::max(1, trials);
+    return *this;
+}
+
+LBFGS& LBFGS::setFirstStep(double step)
+{
+    firstStep = step;
+    return *this;
+}
+
+LBFGS& LBFGS::setMaxStep(double step)
+{
+    maxStep = step;
+    return *this;
+}
+
+EvaluatedControl LBFGS::init(const RVec& x)
+{
+    S.clear();
+    Y.clear();
+    m_x = x;
+    m_current = gradientFn(m_x, m_grad);
+    return m_current;
+}
+
+LBFGS::Trial LBFGS::evaluate(const RVec& d, double alpha)
+{
+    Trial trial;
+    trial.alpha = alpha;
+    trial.eval = gradientFn(m_x + alpha * d, trial.grad);
+    trial.slope = trial.grad.dot(d);
+    return trial;
+}
+
+RVec LBFGS::direction() const
+{
+    RVec q = -m_grad;
+    const int m = S.size();
+    std::vector<double> a(m);
+    for (int i = m - 1; i >= 0; i--) {
+        a[i] = S[i].dot(q) / Y[i].dot(S[i]);
+        q -= a[i] * Y[i];
+    }
+    // Initial Hessian scaled to the most recent curvature
+    if (m > 0) {
+        q *= S.back().dot(Y.back()) / Y.back().squaredNorm();
+    }
+    for (int i = 0; i < m; i++) {
+        const double b = Y[i].dot(q) / Y[i].dot(S[i]);
+        q += (a[i] - b) * S[i];
+    }
+    return q;
+}
+
+// Algorithm 3.6 of Nocedal and Wright, with cubic interpolation where we can
+bool LBFGS::zoom(const RVec& d, Trial lo, Trial hi, const Trial& origin, Trial& accepted)
+{
+    for (int i = 0; i < maxLineSearch; i++) {
+        // Cubic minimiser between lo and hi, falling back to bisection near the ends
+        const double d1 = lo.slope + hi.slope - 3 * (lo.eval.cost - hi.eval.cost) / (lo.alpha - hi.alpha);
+        const double disc = d1 * d1 - lo.slope * hi.slope;
+        double alpha = 0.5 * (lo.alpha + hi.alpha);
+        if (disc >= 0 && std::isfinite(hi.slope)) {
+            const double d2 = std::copysign(std::sqrt(disc), hi.alpha - lo.alpha);
+            const double cubic = hi.alpha - (hi.alpha - lo.alpha) * (hi.slope + d2 - d1) / (hi.slope - lo.slope + 2 * d2);
+            const double margin = 0.1 * std::abs(hi.alpha - lo.alpha);
+            if (std::min(lo.alpha, hi.alpha) + margin < cubic && cubic < std::max(lo.alpha, hi.alpha) - margin) {
+                alpha = cubic;
+            }
+        }
+
+        Trial trial = evaluate(d, alpha);
+        if (trial.eval.cost > origin.eval.cost + c1 * alpha * origin.slope || trial.eval.cost >= lo.eval.cost) {
+            hi = trial;
+        } else {
+            if (std::abs(trial.slope) <= -c2 * origin.slope) {
+                accepted = trial;
+                return true;
+            }
+            if (trial.slope * (hi.alpha - lo.alpha) >= 0) {
+                hi = lo;
+            }
+            lo = trial;
+        }
+    }
+    // Settle for sufficient decrease if that's all we found
+    accepted = lo;
+    return lo.alpha > 0;
+}
+
+// Algorithm 3.5 of Nocedal and Wright
+bool LBFGS::lineSearch(const RVec& d, double alpha, Trial& accepted)
+{
+    const Trial origin { .alpha = 0, .eval = m_current, .grad = m_grad, .slope = m_grad.dot(d) };
+
+    // Screen a few step lengths with cheap concurrent cost evaluations and start from the longest
+    // with sufficient decrease, or bracket below the shortest if none have it
+    if (batchFn && batchTrials > 1) {
+        std::vector<RVec> xs;
+        for (int i = 0; i < batchTrials; i++) {
+            xs.push_back(m_x + std::ldexp(alpha, -i) * d);
+        }
+        const auto evals = batchFn(xs);
+        int best = batchTrials;
+        for (int i = 0; i < batchTrials; i++) {
+            if (evals[i].cost <= origin.eval.cost + c1 * std::ldexp(alpha, -i) * origin.slope) {
+                best = i;
+                break;
+            }
+        }
+        if (best == batchTrials) {
+            // We only know the cost at the end of the bracket
+            Trial hi { .alpha = std::ldexp(alpha, 1 - batchTrials), .eval = evals.back(), .grad = RVec(), .slope = NAN };
+            return zoom(d, origin, hi, origin, accepted);
+        }
+        alpha = std::ldexp(alpha, -best);
+    }
+
+    Trial prev = origin;
+    for (int i = 0; i < maxLineSearch; i++) {
+        Trial trial = evaluate(d, alpha);
+        if (trial.eval.cost > origin.eval.cost + c1 * alpha * origin.slope || (i > 0 && trial.eval.cost >= prev.eval.cost)) {
+            return zoom(d, prev, trial, origin, accepted);
+        }
+        if (std::abs(trial.slope) <= -c2 * origin.slope) {
+            accepted = trial;
+            return true;
+        }
+        if (trial.slope >= 0) {
+            return zoom(d, trial, prev, origin, accepted);
+        }
+        prev = trial;
+        if (2 * alpha * d.cwiseAbs().maxCoeff() > maxStep) {
+            break;
+        }
+        alpha *= 2;
+    }
+    accepted = prev;
+    return prev.alpha > 0;
+}
+
+bool LBFGS::step()
+{
+    RVec d = direction();
+    double alpha = 1;
+    if (S.empty()) {
+        const double dmax = d.cwiseAbs().maxCoeff();
+        alpha = dmax > 0 ? firstStep / dmax : 0;
+    }
+    // Without a descent direction the curvature information is stale
+    if (!(d.dot(m_grad) < 0)) {
+        S.clear();
+        Y.clear();
+        d = -m_grad;
+        const double dmax = d.cwiseAbs().maxCoeff();
+        alpha = dmax > 0 ? firstStep / dmax : 0;
+    }
+    if (alpha == 0) {
+        return false;
+    }
+    alpha = std::min(alpha, maxStep / d.cwiseAbs().maxCoeff());
+
+    Trial accepted;
+    if (!lineSearch(d, alpha, accepted)) {
+        // Retry once along steepest descent before giving up
+        if (S.empty()) {
+            return false;
+        }
+        S.clear();
+        Y.clear();
+        return step();
+    }
+
+    RVec s = accepted.alpha * d;
+    RVec y = accepted.grad - m_grad;
+    // Only keep pairs with positive curvature so H stays positive definite
+    if (s.dot(y) > 1e-12 * s.norm() * y.norm()) {
+        S.push_back(std::move(s));
+        Y.push_back(std::move(y));
+        if ((int)S.size() > memory) {
+            S.pop_front();
+            Y.pop_front();
+        }
+    }
+    m_x += accepted.alpha * d;
+    m_grad = accepted.grad;
+    m_current = accepted.eval;
+    return true;
+}
+
+const RVec& LBFGS::x() const { return m_x; }
+const RVec& LBFGS::gradient() const { return m_grad; }
+const EvaluatedControl& LBFGS::current() const { return m_current; }
@@ -14,8 +14,14 @@ Optimiser::~Optimiser() {}
 
 void Optimiser::updateBest(EvaluatedControl& newBest)
 {
+    // Screened controls are only approximate so we confirm them in double first
+    if (newBest.screened && newBest < bestControl) {
+        newBest = cost.refine(newBest.control);
+    }
     if (newBest < bestControl) {
         bestControl = newBest;
         steps_since_improvement = 0;
     }
 }
+
+bool Optimiser::halted() const { return halt && *halt; }
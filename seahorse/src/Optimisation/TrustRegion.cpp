@@ -0,0 +1,136 @@
+#include "include/Optimisation/TrustRegion.hpp"
+#include "src/Utils/Logger.hpp"
+
+TrustRegion::TrustRegion(GradientFn gradient, HessianFn hessian)
+    : gradientFn(gradient)
+    , hessianFn(hessian)
+{
+}
+
+TrustRegion& TrustRegion::setRadius(double initial, double max)
+{
+    if (initial <= 0 || max < initial) {
+        S_FATAL("Trust radii need 0 < initial <= max, got ", initial, " and ", max);
+    }
+    m_radius = initial;
+    maxRadius = max;
+    return *this;
+}
+
+TrustRegion& TrustRegion::setCGIterations(int iterations)
+{
+    maxCG = std::max(1, iterations);
+    return *this;
+}
+
+EvaluatedControl TrustRegion::init(const RVec& x)
+{
+    m_x = x;
+    m_current = gradientFn(m_x, m_grad);
+    return m_current;
+}
+
+void TrustRegion::init(const RVec& x, const EvaluatedControl& eval, const RVec& grad)
+{
+    m_x = x;
+    m_current = eval;
+    m_grad = grad;
+}
+
+// The largest tau >= 0 with |z + tau d| = radius
+static double toBoundary(const RVec& z, const RVec& d, double radius)
+{
+    const double a = d.squaredNorm();
+    const double b = 2 * z.dot(d);
+    const double c = z.squaredNorm() - radius * radius;
+    return (-b + std::sqrt(std::max(0.0, b * b - 4 * a * c))) / (2 * a);
+}
+
+// Algorithm 7.2 of Nocedal and Wright
+RVec TrustRegion::steihaug(double& predicted)
+{
+    const double gnorm = m_grad.norm();
+    // Forcing term for superlinear convergence
+    const double tol = std::min(0.5, std::sqrt(gnorm)) * gnorm;
+
+    RVec z = RVec::Zero(m_x.size());
+    // Hz, so the model value comes for free
+    RVec Hz = RVec::Zero(m_x.size());
+    RVec r = m_grad;
+    RVec d = -r;
+    RVec Hd;
+    m_products = 0;
+
+    auto model = [&](const RVec& p, const RVec& Hp) { return -(m_grad.dot(p) + 0.5 * p.dot(Hp)); };
+
+    for (int j = 0; j < maxCG; j++) {
+        hessianFn(m_x, d, Hd);
+        m_products++;
+        const double dHd = d.dot(Hd);
+        // Negative curvature: the model decreases all the way to the boundary
+        if (dHd <= 0) {
+            const double tau = toBoundary(z, d, m_radius);
+            z += tau * d;
+            Hz += tau * Hd;
+            break;
+        }
+        const double rr = r.squaredNorm();
+        const double alpha = rr / dHd;
+        if ((z + alpha * d).norm() >= m_radius) {
+            const double tau = toBoundary(z, d, m_radius);
+            z += tau * d;
+            Hz += tau * Hd;
+            break;
+        }
+        z += alpha * d;
+        Hz += alpha * Hd;
+        r += alpha * Hd;
+        if (r.norm() < tol) {
+            break;
+        }
+        d = -r + (r.squaredNorm() / rr) * d;
+    }
+    predicted = model(z, Hz);
+    return z;
+}
+
+bool TrustRegion::step()
+{
+    while (m_radius > minRadius) {
+        if (m_grad.norm() == 0) {
+            return false;
+        }
+        double predicted;
+        const RVec p = steihaug(predicted);
+        if (!(predicted > 0)) {
+            m_radius *= 0.25;
+            continue;
+        }
+
+        RVec grad;
+        EvaluatedControl trial = gradientFn(m_x + p, grad);
+        const double rho = (m_current.cost - trial.cost) / predicted;
+
+        // Shrink if the model was poor, grow if it was good and the step was limited by the radius
+        const double pnorm = p.norm();
+        if (!(rho >= 0.25)) {
+            m_radius = 0.25 * pnorm;
+        } else if (rho > 0.75 && pnorm > 0.99 * m_radius) {
+            m_radius = std::min(2 * m_radius, maxRadius);
+        }
+
+        if (rho > eta) {
+            m_x += p;
+            m_grad = grad;
+            m_current = trial;
+            return true;
+        }
+    }
+    return false;
+}
+
+const RVec& TrustRegion::x() const { return m_x; }
+const RVec& TrustRegion::gradient() const { return m_grad; }
+const EvaluatedControl& TrustRegion::current() const { return m_current; }
+double TrustRegion::radius() const { return m_radius; }
+int TrustRegion::products() const { return m_products; }
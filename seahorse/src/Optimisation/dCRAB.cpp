@@ -24,6 +24,19 @@ EvaluatedControl dCRAB::evaluate(RVec coeffs)
     return cost(control);
 }
 
+std::vector<EvaluatedControl> dCRAB::evaluate(const std::vector<RVec>& coeffs)
+{
+    std::vector<RVec> controls;
+    for (auto& c : coeffs) {
+        RVec control = basis->control(c);
+        for (auto& [dressedCoeffs, dressedBasis] : dressedBases) {
+            control += dressedBasis->control(dressedCoeffs);
+        }
+        controls.push_back(control);
+    }
+    return cost(controls);
+}
+
 // No saver
 dCRAB::dCRAB(Basis& basis, Stopper& stopper, Cost& cost)
     : dCRAB(basis, stopper, cost, [](const Optimiser& opt) { S_LOG(opt.num_iterations, "\tfid= ", opt.bestControl.fid, "\tcost= ", opt.bestControl.cost); })
@@ -35,17 +48,19 @@ void dCRAB::generateSimplex()
     simplex.clear();
 
     // Initial point for simplex
-    RVec initialControl = basis->randomCoeffs() * 0;
-    auto eval = evaluate(initialControl);
-    simplex.push_back({ initialControl, eval.cost });
-    updateBest(eval);
+    std::vector<RVec> points = { basis->randomCoeffs() * 0 };
 
     // Rest of the simplex around the initial guess (n+1 points for n-dim basis)
+    // These are drawn up front so the random sequence doesn't depend on the threading
     for (auto _ = 0; _ <= basis->num_coeffs(); _++) {
-        RVec temp = basis->randomCoeffs();
-        auto eval = evaluate(temp);
-        simplex.push_back({ temp, eval.cost });
-        updateBest(eval);
+        points.push_back(basis->randomCoeffs());
+    }
+
+    // Evaluate them all at once and keep the results in order so runs are reproducible
+    auto evals = evaluate(points);
+    for (size_t i = 0; i < points.size(); i++) {
+        simplex.push_back({ points[i], evals[i].cost });
+        updateBest(evals[i]);
     }
 
     // order simplex by cost
@@ -74,11 +89,23 @@ void dCRAB::step()
     }
     centroid_pt /= (simplex.size() - 1);
 
-    // REFLECTION
+    // Candidate points for this step
     RVec reflection_pt = centroid_pt + alpha * (centroid_pt - simplex.back().coeffs);
+    RVec expansion_pt = centroid_pt + gamma * (reflection_pt - centroid_pt);
+    RVec outside_contraction_pt = centroid_pt + rho * (reflection_pt - centroid_pt);
+    RVec inside_contraction_pt = centroid_pt + rho * (simplex.back().coeffs - centroid_pt);
+
+    // If speculative we evaluate them all now, otherwise only when the logic below asks for them
+    // Either way only the points Nelder-Mead accepts are considered for the best control
+    std::vector<EvaluatedControl> speculated;
+    if (speculative) {
+        speculated = evaluate(std::vector<RVec> { reflection_pt, expansion_pt, outside_contraction_pt, inside_contraction_pt });
+    }
+    auto candidate = [&](size_t i, const RVec& pt) { return speculative ? speculated[i] : evaluate(pt); };
 
+    // REFLECTION
     // evaluate cost at reflection point
-    auto eval = evaluate(reflection_pt);
+    auto eval = candidate(0, reflection_pt);
     SimplexPoint reflected = { reflection_pt, eval.cost };
 
     // reflection is better than second worst point but worse than best point
@@ -96,8 +123,7 @@ void dCRAB::step()
         // we need to save this as we are about to evolve again
         EvaluatedControl reflectedEC = eval;
 
-        RVec expansion_pt = centroid_pt + gamma * (reflection_pt - centroid_pt);
-        auto eval = evaluate(expansion_pt);
+        auto eval = candidate(1, expansion_pt);
         SimplexPoint expanded = { expansion_pt, eval.cost };
 
         simplex.pop_back();
@@ -117,9 +143,8 @@ void dCRAB::step()
     // CONTRACTION
     // reflection is better than worst point
     if (reflected < simplex.back()) {
-        RVec contraction_pt = centroid_pt + rho * (reflection_pt - centroid_pt);
-        auto eval = evaluate(contraction_pt);
-        SimplexPoint contracted = { contraction_pt, eval.cost };
+        auto eval = candidate(2, outside_contraction_pt);
+        SimplexPoint contracted = { outside_contraction_pt, eval.cost };
 
         // contraction is better than reflection
         if (contracted < reflected) {
@@ -131,9 +156,8 @@ void dCRAB::step()
         }
         // reflection worse than worst
     } else if (simplex.back() < reflected) {
-        RVec contraction_pt = centroid_pt + rho * (simplex.back().coeffs - centroid_pt);
-        auto eval = evaluate(contraction_pt);
-        SimplexPoint contracted = { contraction_pt, eval.cost };
+        auto eval = candidate(3, inside_contraction_pt);
+        SimplexPoint contracted = { inside_contraction_pt, eval.cost };
 
         // contraction is better than worst
         if (contracted < simplex.back()) {
@@ -147,16 +171,25 @@ void dCRAB::step()
 
     // SHRINK
     // shrink all points towards best point
+    std::vector<RVec> new_pts;
     for (size_t i = 1; i < simplex.size(); i++) {
-        RVec new_pt = simplex.front().coeffs + sigma * (simplex[i].coeffs - simplex.front().coeffs);
-        auto eval = evaluate(new_pt);
-        simplex[i] = { new_pt, eval.cost };
-        updateBest(eval);
+        new_pts.push_back(simplex.front().coeffs + sigma * (simplex[i].coeffs - simplex.front().coeffs));
+    }
+    auto evals = evaluate(new_pts);
+    for (size_t i = 1; i < simplex.size(); i++) {
+        simplex[i] = { new_pts[i - 1], evals[i - 1].cost };
+        updateBest(evals[i - 1]);
     }
     // S_LOG("Shrink");
     return;
 }
 
+dCRAB& dCRAB::setSpeculative(bool speculative)
+{
+    this->speculative = speculative;
+    return *this;
+}
+
 bool dCRAB::simplexSize(double sizeEpsilon) const
 {
     // find the middle of the simplex
@@ -189,7 +222,7 @@ void dCRAB::optimise(int dressings)
     // Early checking of stopper and saving incase we initialise with a good
     // control
 
-    while ((int)dressedBases.size() < dressings) {
+    while ((int)dressedBases.size() < dressings && !halted()) {
         // order simplex by cost
         std::sort(
             simplex.begin(), simplex.end(),
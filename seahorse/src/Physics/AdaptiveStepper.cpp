@@ -0,0 +1,176 @@
+#include "include/Physics/AdaptiveStepper.hpp"
+#include "include/Physics/Kernels.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+AdaptiveStepper::AdaptiveStepper() { }
+
+AdaptiveStepper::AdaptiveStepper(double dt, HamiltonianFn& H, double tol, int max_level, bool use_imag_pot, FFT::Backend backend)
+    : Stepper(dt, H)
+    , m_tol(tol)
+    , m_max_level(max_level)
+    , m_coarse(H.hs.dim())
+    , m_fine(H.hs.dim())
+    , m_V_buf(H.hs.dim())
+    , m_fft(H.hs.dim(), backend)
+{
+    if (max_level < 0) {
+        S_FATAL("AdaptiveStepper needs a non-negative max_level (got ", max_level, ")");
+    }
+
+    const RVec imagPotstrength = absorber(H.hs);
+
+    // Unnormalised FFTs scale by N on each fwd/inv round trip so we undo that here
+    const double norm = 1.0 / H.hs.dim();
+    for (int level = 0; level <= max_level; level++) {
+        const double dt_L = dt * (1 << level);
+        m_T_half.push_back(norm * (-0.5i * dt_L * H.T_p.array()).exp());
+        m_absorbers.push_back(use_imag_pot ? RVec((-dt_L * imagPotstrength.array()).exp()) : RVec());
+    }
+    m_T_full = norm * (-1.0i * dt * H.T_p.array()).exp();
+}
+
+bool AdaptiveStepper::sameDynamics(const Stepper& other) const
+{
+    if (!Stepper::sameDynamics(other)) {
+        return false;
+    }
+    const auto& o = static_cast<const AdaptiveStepper&>(other);
+    return m_tol == o.m_tol && m_max_level == o.m_max_level && same(m_T_full, o.m_T_full) && m_absorbers.size() == o.m_absorbers.size()
+        && (m_absorbers.empty() || same(m_absorbers[0], o.m_absorbers[0]));
+}
+
+double AdaptiveStepper::midpoint(const RVec& control, int i, int level)
+{
+    // Sample j covers [j, j + 1) so a block of one sample is just that sample
+    // Otherwise the middle of the block falls between two samples
+    if (level == 0) {
+        return control[i];
+    }
+    const int mid = i + (1 << (level - 1));
+    return 0.5 * (control[mid - 1] + control[mid]);
+}
+
+void AdaptiveStepper::kick(CVec& psi, double dt, double u, const double* absorber)
+{
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        applyPhase(psi.data(), m_V->V().data(), dt, absorber, psi.size());
+        break;
+    case Potential::Type::AMPLITUDE:
+        applyPhase(psi.data(), m_V->V().data(), dt * u, absorber, psi.size());
+        break;
+    case Potential::Type::SHAKEN:
+        m_V->ShakenV(u, m_V_buf);
+        applyPhase(psi.data(), m_V_buf.data(), dt, absorber, psi.size());
+        break;
+    default:
+        m_V_buf = (*m_V)(u);
+        applyPhase(psi.data(), m_V_buf.data(), dt, absorber, psi.size());
+        break;
+    }
+}
+
+void AdaptiveStepper::strang(CVec& psi, int level, double u)
+{
+    const double dt_L = m_dt * (1 << level);
+    const double* absorber = m_absorbers[level].size() ? m_absorbers[level].data() : nullptr;
+
+    m_fft.fwd(psi);
+    psi.array() *= m_T_half[level].array();
+    m_fft.inv(psi);
+    kick(psi, dt_L, u, absorber);
+    m_fft.fwd(psi);
+    psi.array() *= m_T_half[level].array();
+    m_fft.inv(psi);
+}
+
+void AdaptiveStepper::fused(CVec& psi, const RVec& control, int i, int count)
+{
+    const double* absorber = m_absorbers[0].size() ? m_absorbers[0].data() : nullptr;
+
+    m_fft.fwd(psi);
+    psi.array() *= m_T_half[0].array();
+    for (int j = i; j < i + count; j++) {
+        m_fft.inv(psi);
+        kick(psi, m_dt, control[j], absorber);
+        m_fft.fwd(psi);
+        psi.array() *= (j < i + count - 1 ? m_T_full : m_T_half[0]).array();
+    }
+    m_fft.inv(psi);
+}
+
+void AdaptiveStepper::reset(const CVec& psi_0)
+{
+    m_psi_f = psi_0.normalized();
+}
+
+void AdaptiveStepper::step(double u)
+{
+    strang(m_psi_f, 0, u);
+}
+
+void AdaptiveStepper::evolve(const CVec& psi_0, const RVec& control)
+{
+    reset(psi_0);
+    m_steps = 0;
+    m_rejections = 0;
+    // Start from dt every time so an evaluation doesn't depend on the previous one
+    m_level = 0;
+    int wait = 0;
+    int backoff = 1;
+
+    const int n = control.size();
+    int i = 0;
+    while (i < n) {
+        // Don't run past the end of the control
+        while (m_level > 0 && i + (1 << m_level) > n) {
+            m_level--;
+        }
+
+        // We can't go below dt so these are always accepted
+        // Any backoff is taken in one go then we try a bigger block again
+        if (m_level == 0) {
+            const int count = std::min(wait + 1, n - i);
+            fused(m_psi_f, control, i, count);
+            i += count;
+            m_steps += count;
+            wait = 0;
+            m_level = std::min(1, m_max_level);
+            continue;
+        }
+
+        // One big step against two half steps
+        const int half = 1 << (m_level - 1);
+        m_coarse = m_psi_f;
+        m_fine = m_psi_f;
+        strang(m_coarse, m_level, midpoint(control, i, m_level));
+        strang(m_fine, m_level - 1, midpoint(control, i, m_level - 1));
+        strang(m_fine, m_level - 1, midpoint(control, i + half, m_level - 1));
+        const double err = (m_coarse - m_fine).norm();
+
+        if (err > m_tol) {
+            m_level--;
+            m_rejections++;
+            // Back off exponentially from repeatedly failing to leave dt
+            if (m_level == 0) {
+                wait = backoff;
+                backoff = std::min(2 * backoff, 1 << m_max_level);
+            }
+            continue;
+        }
+        backoff = 1;
+
+        // Keep the more accurate half steps
+        m_psi_f.swap(m_fine);
+        i += 2 * half;
+        m_steps++;
+        // Strang's local error goes as dt^3 so doubling the step is safe below tol/8
+        if (err < m_tol / 8 && m_level < m_max_level) {
+            m_level++;
+        }
+    }
+}
+
+int AdaptiveStepper::steps() const { return m_steps; }
+int AdaptiveStepper::rejections() const { return m_rejections; }
@@ -0,0 +1,185 @@
+#include "include/Physics/ChebyshevStepper.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+ChebyshevStepper::ChebyshevStepper() { }
+
+ChebyshevStepper::ChebyshevStepper(double dt, HamiltonianFn& H, int min_run, double tol, bool use_imag_pot, FFT::Backend backend)
+    : SplitStepper(dt, H, use_imag_pot, backend)
+    , m_T_p(H.T_p)
+    , m_min_run(std::max(1, min_run))
+    , m_tol(tol)
+    , m_cheb_fft(H.hs.dim(), backend)
+{
+    // Same absorbing boundary as the split-step
+    if (use_imag_pot) {
+        m_absorb = absorber(H.hs);
+    }
+}
+
+bool ChebyshevStepper::sameDynamics(const Stepper& other) const
+{
+    if (!SplitStepper::sameDynamics(other)) {
+        return false;
+    }
+    const auto& o = static_cast<const ChebyshevStepper&>(other);
+    return m_min_run == o.m_min_run && m_tol == o.m_tol;
+}
+
+RVec ChebyshevStepper::bessel(double a, int K)
+{
+    // Start well above K where J_k is negligible and recurse down, rescaling to avoid overflow
+    int M = K + 20 + (int)std::sqrt(40.0 * K);
+    M += M % 2;
+    RVec J = RVec::Zero(M + 2);
+    J[M] = 1e-300;
+    for (int k = M; k >= 1; k--) {
+        J[k - 1] = 2.0 * k / a * J[k] - J[k + 1];
+        if (std::abs(J[k - 1]) > 1e250) {
+            J.segment(k - 1, M + 3 - k) *= 1e-250;
+        }
+    }
+    // Normalise with J_0 + 2 sum J_2k = 1
+    double norm = J[0];
+    for (int k = 2; k <= M; k += 2) {
+        norm += 2 * J[k];
+    }
+    return J.head(K + 1) / norm;
+}
+
+void ChebyshevStepper::applyScaledH(const CVec& in, CVec& out)
+{
+    out = in;
+    m_cheb_fft.fwd(out);
+    out.array() *= m_T_scaled.array();
+    m_cheb_fft.inv(out);
+    out.array() += m_V_scaled.array() * in.array();
+    m_applications++;
+}
+
+void ChebyshevStepper::bounds(const RVec& V, double& Ec, double& dE) const
+{
+    // A little room for rounding
+    const double Emin = m_T_p.minCoeff() + V.minCoeff();
+    const double Emax = m_T_p.maxCoeff() + V.maxCoeff();
+    dE = 0.5 * (Emax - Emin) * (1 + 1e-9) + 1e-12;
+    Ec = 0.5 * (Emax + Emin);
+}
+
+RVec ChebyshevStepper::coefficients(double a) const
+{
+    // J_k(a) decays super-exponentially once k > a so this is plenty, then drop the negligible tail
+    const RVec J = bessel(a, (int)(a + 10 + 30 * std::cbrt(a)));
+    int K = J.size() - 1;
+    while (K > a && std::abs(J[K]) < 0.5 * m_tol) {
+        K--;
+    }
+    return J.head(K + 1);
+}
+
+bool ChebyshevStepper::cheaper(double u, int samples) const
+{
+    // K applications of H against one split-step per sample, both two FFTs each
+    double Ec, dE;
+    bounds((*m_V)(u), Ec, dE);
+    return coefficients(dE * samples * m_dt).size() - 1 < samples;
+}
+
+void ChebyshevStepper::chebyshev(CVec& psi, double u, double tau)
+{
+    const RVec V = (*m_V)(u);
+    double Ec, dE;
+    bounds(V, Ec, dE);
+    m_T_scaled = m_T_p / (dE * m_T_p.size());
+    m_V_scaled = (V.array() - Ec) / dE;
+
+    const RVec J = coefficients(dE * tau);
+    const int K = J.size() - 1;
+
+    // T_0 and T_1 terms then the three term recurrence phi_k+1 = 2 H phi_k - phi_k-1
+    m_phi_prev = psi;
+    m_sum = J[0] * m_phi_prev;
+    applyScaledH(m_phi_prev, m_phi);
+    m_sum += -2.0i * J[1] * m_phi;
+    std::complex<double> coeff = -2.0i;
+    for (int k = 2; k <= K; k++) {
+        applyScaledH(m_phi, m_phi_next);
+        m_phi_next = 2 * m_phi_next - m_phi_prev;
+        coeff *= -1.0i;
+        m_sum += coeff * J[k] * m_phi_next;
+        m_phi_prev.swap(m_phi);
+        m_phi.swap(m_phi_next);
+    }
+    psi = std::polar(1.0, -Ec * tau) * m_sum;
+}
+
+void ChebyshevStepper::evolve(const CVec& psi_0, const RVec& control)
+{
+    reset(psi_0);
+    m_segments = 0;
+    m_applications = 0;
+
+    const int n = control.size();
+    // Start of the split-step samples we haven't propagated yet
+    int pending = 0;
+    int i = 0;
+    while (i < n) {
+        int end = i + 1;
+        while (end < n && control[end] == control[i]) {
+            end++;
+        }
+        if (end - i < m_min_run || !cheaper(control[i], end - i)) {
+            i = end;
+            continue;
+        }
+
+        // Catch up on the varying samples before this run
+        if (i > pending) {
+            propagateState(control.segment(pending, i - pending));
+        }
+
+        propagateRun(control[i], (end - i) * m_dt);
+        m_segments++;
+        i = pending = end;
+    }
+    if (n > pending) {
+        propagateState(control.segment(pending, n - pending));
+    }
+}
+
+void ChebyshevStepper::propagateRun(double u, double tau)
+{
+    // The absorber is split symmetrically around the run
+    if (m_absorb.size()) {
+        m_psi_f.array() *= (-0.5 * tau * m_absorb.array()).exp();
+    }
+    chebyshev(m_psi_f, u, tau);
+    if (m_absorb.size()) {
+        m_psi_f.array() *= (-0.5 * tau * m_absorb.array()).exp();
+    }
+}
+
+void ChebyshevStepper::evolveBatch(const CMat& psi_0s, const RVec& control)
+{
+    Stepper::evolveBatch(psi_0s, control);
+}
+
+void ChebyshevStepper::stepBack(double) { S_FATAL("ChebyshevStepper only evolves forwards, use a SplitStepper to step back"); }
+CVec ChebyshevStepper::overlapGradient(const CVec&, const CVec&, const RVec&, TrajectoryStore&, std::complex<double>&)
+{
+    S_FATAL("ChebyshevStepper doesn't provide gradients, use a SplitStepper");
+}
+CVec ChebyshevStepper::overlapHessianProduct(const CVec&, const CVec&, const RVec&, const RVec&, TrajectoryStore&, std::complex<double>&, CVec&)
+{
+    S_FATAL("ChebyshevStepper doesn't provide Hessian products, use a SplitStepper");
+}
+void ChebyshevStepper::stepBlock(CMat&, double) { S_FATAL("ChebyshevStepper doesn't provide block steps, use a SplitStepper"); }
+void ChebyshevStepper::adjointStep(CMat&, double) { S_FATAL("ChebyshevStepper doesn't provide block steps, use a SplitStepper"); }
+void ChebyshevStepper::adjointStepBack(CMat&, double) { S_FATAL("ChebyshevStepper doesn't provide block steps, use a SplitStepper"); }
+std::complex<double> ChebyshevStepper::stepDerivative(const CMat&, const CMat&, double)
+{
+    S_FATAL("ChebyshevStepper doesn't provide block steps, use a SplitStepper");
+}
+
+int ChebyshevStepper::segments() const { return m_segments; }
+int ChebyshevStepper::applications() const { return m_applications; }
@@ -0,0 +1,187 @@
+#include "include/Physics/CompositionStepper.hpp"
+#include "include/Physics/Kernels.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <numeric>
+
+CompositionStepper::CompositionStepper() { }
+
+CompositionStepper::CompositionStepper(double dt, HamiltonianFn& H, Coefficients coeffs, int order, bool use_imag_pot, FFT::Backend backend)
+    : Stepper(dt, H)
+    , m_a(coeffs.a)
+    , m_b(coeffs.b)
+    , m_order(order)
+    , m_V_buf(H.hs.dim())
+    , m_fft(H.hs.dim(), backend)
+{
+    if (m_a.size() != m_b.size() + 1) {
+        S_FATAL("A composition needs one more kinetic than potential coefficient (", m_a.size(), " vs ", m_b.size(), ")");
+    }
+
+    // Kick j happens after a_0 + ... + a_j of the step
+    std::partial_sum(m_a.begin(), m_a.end() - 1, std::back_inserter(m_c));
+
+    // Unnormalised FFTs scale by N on each fwd/inv round trip so we undo that here
+    const double norm = 1.0 / H.hs.dim();
+    for (double a_j : m_a) {
+        m_T_exps.push_back(norm * (-1.0i * a_j * dt * H.T_p.array()).exp());
+    }
+    m_T_join = norm * (-1.0i * (m_a.back() + m_a.front()) * dt * H.T_p.array()).exp();
+
+    if (use_imag_pot) {
+        imagPot = (-m_dt * absorber(H.hs).array()).exp();
+    }
+}
+
+bool CompositionStepper::sameDynamics(const Stepper& other) const
+{
+    if (!Stepper::sameDynamics(other)) {
+        return false;
+    }
+    const auto& o = static_cast<const CompositionStepper&>(other);
+    return m_a == o.m_a && m_b == o.m_b && same(m_T_join, o.m_T_join) && same(imagPot, o.imagPot);
+}
+
+CompositionStepper::Coefficients CompositionStepper::tripleJump(const Coefficients& method, int order)
+{
+    const double z1 = 1.0 / (2.0 - std::pow(2.0, 1.0 / (order + 1)));
+    const double z0 = 1.0 - 2.0 * z1;
+
+    Coefficients jumped = { .a = { 0.0 }, .b = {} };
+    for (double z : { z1, z0, z1 }) {
+        // The trailing kinetic part of the previous method merges with our leading one
+        jumped.a.back() += z * method.a.front();
+        for (size_t j = 0; j < method.b.size(); j++) {
+            jumped.b.push_back(z * method.b[j]);
+            jumped.a.push_back(z * method.a[j + 1]);
+        }
+    }
+    return jumped;
+}
+
+int CompositionStepper::order() const { return m_order; }
+int CompositionStepper::stages() const { return m_b.size(); }
+
+double CompositionStepper::interpolate(const RVec& control, int i, double c) const
+{
+    // Sample k sits at (k + 1/2) dt, so in sample units we want the control at t = i + c - 1/2
+    const double t = i + c - 0.5;
+
+    // A window of m_order samples centred on t, shifted to stay inside the control
+    const int n = control.size();
+    const int width = std::min(m_order, n);
+    const int start = std::clamp(static_cast<int>(std::floor(t - (width - 1) / 2.0 + 0.5)), 0, n - width);
+
+    // Lagrange interpolation at t
+    double u = 0;
+    for (int k = start; k < start + width; k++) {
+        double weight = 1;
+        for (int l = start; l < start + width; l++) {
+            if (l != k) {
+                weight *= (t - l) / (k - l);
+            }
+        }
+        u += weight * control[k];
+    }
+    return u;
+}
+
+void CompositionStepper::applyPotential(CVec& psi, double u, double b, bool absorb)
+{
+    const double* absorber = absorb && imagPot.size() ? imagPot.data() : nullptr;
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        applyPhase(psi.data(), m_V->V().data(), b * m_dt, absorber, psi.size());
+        break;
+    case Potential::Type::AMPLITUDE:
+        applyPhase(psi.data(), m_V->V().data(), b * m_dt * u, absorber, psi.size());
+        break;
+    case Potential::Type::SHAKEN:
+        m_V->ShakenV(u, m_V_buf);
+        applyPhase(psi.data(), m_V_buf.data(), b * m_dt, absorber, psi.size());
+        break;
+    default:
+        m_V_buf = (*m_V)(u);
+        applyPhase(psi.data(), m_V_buf.data(), b * m_dt, absorber, psi.size());
+        break;
+    }
+}
+
+void CompositionStepper::reset(const CVec& psi_0)
+{
+    m_psi_f = psi_0.normalized();
+}
+
+void CompositionStepper::step(double u)
+{
+    // With a single sample the interpolation holds the control constant
+    propagate(RVec::Constant(1, u));
+}
+
+void CompositionStepper::evolve(const CVec& psi_0, const RVec& control)
+{
+    reset(psi_0);
+    propagate(control);
+}
+
+void CompositionStepper::propagate(const RVec& control)
+{
+    const int n = control.size();
+    const int m = m_b.size();
+    // The kick the absorber is applied at
+    const int middle = m / 2;
+
+    m_fft.fwd(m_psi_f);
+    m_psi_f.array() *= m_T_exps.front().array();
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+            m_fft.inv(m_psi_f);
+            applyPotential(m_psi_f, interpolate(control, i, m_c[j]), m_b[j], j == middle);
+            m_fft.fwd(m_psi_f);
+            // Fuse the last kinetic part with the first of the next step
+            const CVec& T_exp = j < m - 1 ? m_T_exps[j + 1] : (i < n - 1 ? m_T_join : m_T_exps.back());
+            m_psi_f.array() *= T_exp.array();
+        }
+    }
+    m_fft.inv(m_psi_f);
+}
+
+YoshidaStepper::YoshidaStepper() { }
+
+YoshidaStepper::YoshidaStepper(double dt, HamiltonianFn& H, int order, bool use_imag_pot, FFT::Backend backend)
+    : CompositionStepper(dt, H, coefficients(order), order, use_imag_pot, backend)
+{
+}
+
+CompositionStepper::Coefficients YoshidaStepper::coefficients(int order)
+{
+    if (order != 4 && order != 6) {
+        S_FATAL("Yoshida steppers are only available in order 4 or 6 (got ", order, ")");
+    }
+    // Start from Strang splitting and jump up to the requested order
+    Coefficients method = { .a = { 0.5, 0.5 }, .b = { 1.0 } };
+    for (int o = 2; o < order; o += 2) {
+        method = tripleJump(method, o);
+    }
+    return method;
+}
+
+BlanesMoanStepper::BlanesMoanStepper() { }
+
+BlanesMoanStepper::BlanesMoanStepper(double dt, HamiltonianFn& H, bool use_imag_pot, FFT::Backend backend)
+    : CompositionStepper(dt, H, coefficients(), 4, use_imag_pot, backend)
+{
+}
+
+CompositionStepper::Coefficients BlanesMoanStepper::coefficients()
+{
+    const double a1 = 0.0792036964311957;
+    const double a2 = 0.353172906049774;
+    const double a3 = -0.0420650803577195;
+    const double a4 = 1.0 - 2.0 * (a1 + a2 + a3);
+    const double b1 = 0.209515106613362;
+    const double b2 = -0.143851773179818;
+    const double b3 = 0.5 - (b1 + b2);
+    return { .a = { a1, a2, a3, a4, a3, a2, a1 }, .b = { b1, b2, b3, b3, b2, b1 } };
+}
@@ -0,0 +1,213 @@
+#include "include/Physics/FFT.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <libs/eigen/unsupported/Eigen/FFT>
+
+#ifdef EIGEN_USE_MKL_ALL
+#include <mkl_dfti.h>
+#endif
+
+namespace {
+
+// Fallback using kissfft, which only works out-of-place so we keep our own scratch buffer
+class KissFFT : public FFTBackend {
+private:
+    Eigen::FFT<double> m_fft;
+    CVec m_buf;
+    Eigen::FFT<float> m_fftf;
+    CVecf m_buff;
+
+    void planSingle()
+    {
+        if (m_buff.size() == 0) {
+            m_fftf.SetFlag(Eigen::FFT<float>::Unscaled);
+            m_buff = CVecf::Zero(m_buf.size());
+        }
+    }
+
+public:
+    KissFFT(int n)
+        : m_buf(CVec::Zero(n))
+    {
+        m_fft.SetFlag(Eigen::FFT<double>::Unscaled);
+        // Plan both directions up front
+        m_fft.fwd(m_buf.data(), m_buf.data(), n);
+        m_fft.inv(m_buf.data(), m_buf.data(), n);
+    }
+
+    std::unique_ptr<FFTBackend> clone() const override { return std::make_unique<KissFFT>(m_buf.size()); }
+
+    void fwd(std::complex<double>* data, int howmany) override
+    {
+        const auto n = m_buf.size();
+        for (int j = 0; j < howmany; j++) {
+            m_buf = CVec::Map(data + j * n, n);
+            m_fft.fwd(data + j * n, m_buf.data(), n);
+        }
+    }
+
+    void inv(std::complex<double>* data, int howmany) override
+    {
+        const auto n = m_buf.size();
+        for (int j = 0; j < howmany; j++) {
+            m_buf = CVec::Map(data + j * n, n);
+            m_fft.inv(data + j * n, m_buf.data(), n);
+        }
+    }
+
+    void fwd(std::complex<float>* data, int howmany) override
+    {
+        planSingle();
+        const auto n = m_buff.size();
+        for (int j = 0; j < howmany; j++) {
+            m_buff = CVecf::Map(data + j * n, n);
+            m_fftf.fwd(data + j * n, m_buff.data(), n);
+        }
+    }
+
+    void inv(std::complex<float>* data, int howmany) override
+    {
+        planSingle();
+        const auto n = m_buff.size();
+        for (int j = 0; j < howmany; j++) {
+            m_buff = CVecf::Map(data + j * n, n);
+            m_fftf.inv(data + j * n, m_buff.data(), n);
+        }
+    }
+};
+
+#ifdef EIGEN_USE_MKL_ALL
+// MKL DFTI descriptors are committed once for single transforms and re-committed only when the batch size changes
+class MKLFFT : public FFTBackend {
+private:
+    // Committed descriptors for one precision
+    struct Plans {
+        DFTI_DESCRIPTOR_HANDLE single = nullptr;
+        DFTI_DESCRIPTOR_HANDLE batch = nullptr;
+        int howmany = 0;
+    };
+
+    int m_n;
+    Plans m_double;
+    Plans m_float;
+
+    static void check(MKL_LONG status)
+    {
+        if (status != 0 && !DftiErrorClass(status, DFTI_NO_ERROR)) {
+            S_FATAL("MKL DFTI error: ", DftiErrorMessage(status));
+        }
+    }
+
+    static DFTI_DESCRIPTOR_HANDLE plan(int n, int howmany, DFTI_CONFIG_VALUE precision)
+    {
+        DFTI_DESCRIPTOR_HANDLE handle = nullptr;
+        check(DftiCreateDescriptor(&handle, precision, DFTI_COMPLEX, 1, (MKL_LONG)n));
+        check(DftiSetValue(handle, DFTI_PLACEMENT, DFTI_INPLACE));
+        if (howmany > 1) {
+            check(DftiSetValue(handle, DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG)howmany));
+            check(DftiSetValue(handle, DFTI_INPUT_DISTANCE, (MKL_LONG)n));
+            check(DftiSetValue(handle, DFTI_OUTPUT_DISTANCE, (MKL_LONG)n));
+        }
+        check(DftiCommitDescriptor(handle));
+        return handle;
+    }
+
+    DFTI_DESCRIPTOR_HANDLE handle(Plans& plans, int howmany, DFTI_CONFIG_VALUE precision)
+    {
+        if (howmany == 1) {
+            if (!plans.single) {
+                plans.single = plan(m_n, 1, precision);
+            }
+            return plans.single;
+        }
+        if (howmany != plans.howmany) {
+            if (plans.batch) {
+                DftiFreeDescriptor(&plans.batch);
+            }
+            plans.batch = plan(m_n, howmany, precision);
+            plans.howmany = howmany;
+        }
+        return plans.batch;
+    }
+
+    static void release(Plans& plans)
+    {
+        if (plans.single) {
+            DftiFreeDescriptor(&plans.single);
+        }
+        if (plans.batch) {
+            DftiFreeDescriptor(&plans.batch);
+        }
+    }
+
+public:
+    MKLFFT(int n)
+        : m_n(n)
+    {
+        m_double.single = plan(n, 1, DFTI_DOUBLE);
+    }
+
+    ~MKLFFT() override
+    {
+        release(m_double);
+        release(m_float);
+    }
+
+    std::unique_ptr<FFTBackend> clone() const override { return std::make_unique<MKLFFT>(m_n); }
+
+    void fwd(std::complex<double>* data, int howmany) override { check(DftiComputeForward(handle(m_double, howmany, DFTI_DOUBLE), data)); }
+    void inv(std::complex<double>* data, int howmany) override { check(DftiComputeBackward(handle(m_double, howmany, DFTI_DOUBLE), data)); }
+    void fwd(std::complex<float>* data, int howmany) override { check(DftiComputeForward(handle(m_float, howmany, DFTI_SINGLE), data)); }
+    void inv(std::complex<float>* data, int howmany) override { check(DftiComputeBackward(handle(m_float, howmany, DFTI_SINGLE), data)); }
+};
+#endif
+
+} // namespace
+
+FFT::FFT(int n, Backend backend)
+    : m_n(n)
+{
+    switch (backend) {
+    case Backend::DEFAULT:
+#ifdef EIGEN_USE_MKL_ALL
+        m_backend = std::make_unique<MKLFFT>(n);
+#else
+        m_backend = std::make_unique<KissFFT>(n);
+#endif
+        break;
+    case Backend::KISS:
+        m_backend = std::make_unique<KissFFT>(n);
+        break;
+    case Backend::MKL:
+#ifdef EIGEN_USE_MKL_ALL
+        m_backend = std::make_unique<MKLFFT>(n);
+#else
+        S_FATAL("MKL FFT backend requested but seahorse was built without MKL");
+#endif
+        break;
+    default:
+        S_FATAL("Unknown FFT backend");
+    }
+}
+
+FFT::FFT(const FFT& other)
+    : m_n(other.m_n)
+    , m_backend(other.m_backend ? other.m_backend->clone() : nullptr)
+{
+}
+
+FFT& FFT::operator=(const FFT& other)
+{
+    m_n = other.m_n;
+    m_backend = other.m_backend ? other.m_backend->clone() : nullptr;
+    return *this;
+}
+
+void FFT::fwd(CVec& psi) { m_backend->fwd(psi.data(), 1); }
+void FFT::inv(CVec& psi) { m_backend->inv(psi.data(), 1); }
+void FFT::fwd(CMat& psis) { m_backend->fwd(psis.data(), psis.cols()); }
+void FFT::inv(CMat& psis) { m_backend->inv(psis.data(), psis.cols()); }
+void FFT::fwd(CVecf& psi) { m_backend->fwd(psi.data(), 1); }
+void FFT::inv(CVecf& psi) { m_backend->inv(psi.data(), 1); }
+
+int FFT::size() const { return m_n; }
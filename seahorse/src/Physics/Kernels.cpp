@@ -0,0 +1,176 @@
+#include "include/Physics/Kernels.hpp"
+
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace {
+
+// sin/cos of 4 doubles
+// Reduce by the nearest multiple of pi/2 (3 part Cody-Waite with fma) then use the cephes polynomials on [-pi/4, pi/4]
+inline void sincos4(__m256d x, __m256d& s, __m256d& c)
+{
+    const __m256d q = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(M_2_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(1.5707963267948966), x);
+    r = _mm256_fnmadd_pd(q, _mm256_set1_pd(6.123233995736766e-17), r);
+    r = _mm256_fnmadd_pd(q, _mm256_set1_pd(-1.4973849048591698e-33), r);
+    const __m256d z = _mm256_mul_pd(r, r);
+
+    __m256d ps = _mm256_set1_pd(1.58962301576546568060e-10);
+    ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(-2.50507477628578072866e-8));
+    ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(2.75573136213857245213e-6));
+    ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(-1.98412698295895385996e-4));
+    ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(8.33333333332211858878e-3));
+    ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(-1.66666666666666307295e-1));
+    const __m256d sr = _mm256_fmadd_pd(_mm256_mul_pd(r, z), ps, r);
+
+    __m256d pc = _mm256_set1_pd(-1.13585365213876817300e-11);
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(2.08757008419747316778e-9));
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(-2.75573141792967388112e-7));
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(2.48015872888517045348e-5));
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(-1.38888888888730564116e-3));
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(4.16666666666665929218e-2));
+    const __m256d cr = _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc, _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1.0)));
+
+    // Quadrant q: odd swaps sin/cos, bit 1 of q (q+1) flips the sign of sin (cos)
+    const __m256i qi = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q));
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(qi, one), one));
+    const __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(qi, _mm256_set1_epi64x(2)), 62));
+    const __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(qi, one), _mm256_set1_epi64x(2)), 62));
+
+    s = _mm256_xor_pd(_mm256_blendv_pd(sr, cr, swap), sin_sign);
+    c = _mm256_xor_pd(_mm256_blendv_pd(cr, sr, swap), cos_sign);
+}
+
+// Real and (negated) imaginary parts of absorber * exp(-i * scale * V) for 4 points, duplicated to match interleaved complex storage
+inline void phase4(const double* V, __m256d scale, const double* absorber, __m256d& re_lo, __m256d& re_hi, __m256d& nim_lo, __m256d& nim_hi)
+{
+    __m256d s, c;
+    sincos4(_mm256_mul_pd(scale, _mm256_loadu_pd(V)), s, c);
+    if (absorber) {
+        const __m256d a = _mm256_loadu_pd(absorber);
+        s = _mm256_mul_pd(s, a);
+        c = _mm256_mul_pd(c, a);
+    }
+    // exp(-i theta) has imaginary part -sin(theta), so -im = sin
+    re_lo = _mm256_permute4x64_pd(c, 0x50);
+    re_hi = _mm256_permute4x64_pd(c, 0xFA);
+    nim_lo = _mm256_permute4x64_pd(s, 0x50);
+    nim_hi = _mm256_permute4x64_pd(s, 0xFA);
+}
+
+// (p * f) for 2 interleaved complex numbers given re(f) and -im(f)
+inline __m256d cmul(__m256d p, __m256d re, __m256d nim)
+{
+    // even lanes: p.re * re + p.im * nim, odd lanes: p.im * re - p.re * nim
+    const __m256d swapped = _mm256_permute_pd(p, 0b0101);
+    return _mm256_fmaddsub_pd(p, re, _mm256_mul_pd(swapped, _mm256_sub_pd(_mm256_setzero_pd(), nim)));
+}
+
+// sin/cos of 8 floats, as sincos4 with the single precision cephes constants
+inline void sincos8(__m256 x, __m256& s, __m256& c)
+{
+    const __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(M_2_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(1.5703125f), x);
+    r = _mm256_fnmadd_ps(q, _mm256_set1_ps(4.837512969970703125e-4f), r);
+    r = _mm256_fnmadd_ps(q, _mm256_set1_ps(7.54978995489188216e-8f), r);
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    __m256 ps = _mm256_set1_ps(-1.9515295891e-4f);
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(8.3321608736e-3f));
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(-1.6666654611e-1f));
+    const __m256 sr = _mm256_fmadd_ps(_mm256_mul_ps(r, z), ps, r);
+
+    __m256 pc = _mm256_set1_ps(2.443315711809948e-5f);
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(-1.388731625493765e-3f));
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(4.166664568298827e-2f));
+    const __m256 cr = _mm256_fmadd_ps(_mm256_mul_ps(z, z), pc, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)));
+
+    const __m256i qi = _mm256_cvtps_epi32(q);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(qi, one), one));
+    const __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(2)), 30));
+    const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(qi, one), _mm256_set1_epi32(2)), 30));
+
+    s = _mm256_xor_ps(_mm256_blendv_ps(sr, cr, swap), sin_sign);
+    c = _mm256_xor_ps(_mm256_blendv_ps(cr, sr, swap), cos_sign);
+}
+
+// (p * f) for 4 interleaved complex floats given re(f) and -im(f)
+inline __m256 cmul(__m256 p, __m256 re, __m256 nim)
+{
+    const __m256 swapped = _mm256_permute_ps(p, 0b10110001);
+    return _mm256_fmaddsub_ps(p, re, _mm256_mul_ps(swapped, _mm256_sub_ps(_mm256_setzero_ps(), nim)));
+}
+
+} // namespace
+#endif
+
+void applyPhase(std::complex<double>* psi, const double* V, double scale, const double* absorber, int n)
+{
+    int j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    double* p = reinterpret_cast<double*>(psi);
+    const __m256d vscale = _mm256_set1_pd(scale);
+    for (; j + 4 <= n; j += 4) {
+        __m256d re_lo, re_hi, nim_lo, nim_hi;
+        phase4(V + j, vscale, absorber ? absorber + j : nullptr, re_lo, re_hi, nim_lo, nim_hi);
+        _mm256_storeu_pd(p + 2 * j, cmul(_mm256_loadu_pd(p + 2 * j), re_lo, nim_lo));
+        _mm256_storeu_pd(p + 2 * j + 4, cmul(_mm256_loadu_pd(p + 2 * j + 4), re_hi, nim_hi));
+    }
+#endif
+    for (; j < n; j++) {
+        const double a = absorber ? absorber[j] : 1.0;
+        psi[j] *= std::polar(a, -scale * V[j]);
+    }
+}
+
+void makePhase(std::complex<double>* out, const double* V, double scale, const double* absorber, int n)
+{
+    int j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    double* o = reinterpret_cast<double*>(out);
+    const __m256d vscale = _mm256_set1_pd(scale);
+    const __m256d conj = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+    for (; j + 4 <= n; j += 4) {
+        __m256d re_lo, re_hi, nim_lo, nim_hi;
+        phase4(V + j, vscale, absorber ? absorber + j : nullptr, re_lo, re_hi, nim_lo, nim_hi);
+        // interleave (re, -im) then flip the sign of the imaginary lanes
+        _mm256_storeu_pd(o + 2 * j, _mm256_xor_pd(_mm256_blend_pd(re_lo, nim_lo, 0b1010), conj));
+        _mm256_storeu_pd(o + 2 * j + 4, _mm256_xor_pd(_mm256_blend_pd(re_hi, nim_hi, 0b1010), conj));
+    }
+#endif
+    for (; j < n; j++) {
+        const double a = absorber ? absorber[j] : 1.0;
+        out[j] = std::polar(a, -scale * V[j]);
+    }
+}
+
+void applyPhase(std::complex<float>* psi, const float* V, float scale, const float* absorber, int n)
+{
+    int j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    float* p = reinterpret_cast<float*>(psi);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256i lo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i hi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    for (; j + 8 <= n; j += 8) {
+        __m256 s, c;
+        sincos8(_mm256_mul_ps(vscale, _mm256_loadu_ps(V + j)), s, c);
+        if (absorber) {
+            const __m256 a = _mm256_loadu_ps(absorber + j);
+            s = _mm256_mul_ps(s, a);
+            c = _mm256_mul_ps(c, a);
+        }
+        // Duplicate each factor over the (re, im) pair it multiplies
+        _mm256_storeu_ps(p + 2 * j, cmul(_mm256_loadu_ps(p + 2 * j), _mm256_permutevar8x32_ps(c, lo), _mm256_permutevar8x32_ps(s, lo)));
+        _mm256_storeu_ps(p + 2 * j + 8, cmul(_mm256_loadu_ps(p + 2 * j + 8), _mm256_permutevar8x32_ps(c, hi), _mm256_permutevar8x32_ps(s, hi)));
+    }
+#endif
+    for (; j < n; j++) {
+        const float a = absorber ? absorber[j] : 1.0f;
+        psi[j] *= std::polar(a, -scale * V[j]);
+    }
+}
@@ -0,0 +1,185 @@
+#include "include/Physics/KrylovStepper.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <libs/eigen/Eigen/Eigenvalues>
+
+KrylovStepper::KrylovStepper() { }
+
+KrylovStepper::KrylovStepper(double dt, HamiltonianFn& H, double tol, int max_dim, bool use_imag_pot)
+    : Stepper(dt, H)
+    , m_H(H.hs.T())
+    , m_V_buf(H.hs.dim())
+    , m_tol(tol)
+    , m_max_dim(max_dim)
+    , m_Q(H.hs.dim(), max_dim + 1)
+    , m_alpha(max_dim)
+    , m_beta(max_dim)
+    , m_w(H.hs.dim())
+    , m_start(H.hs.dim())
+{
+    if (max_dim < 2) {
+        S_FATAL("KrylovStepper needs a subspace of at least 2 vectors (got ", max_dim, ")");
+    }
+    if (use_imag_pot) {
+        imagPot = (-m_dt * absorber(H.hs).array()).exp();
+    }
+
+    // Make sure every diagonal entry is stored then remember where they are
+    const int N = m_H.rows();
+    for (int j = 0; j < N; j++) {
+        m_H.coeffRef(j, j) += 0.0;
+    }
+    m_H.makeCompressed();
+    m_T_diag = m_H.diagonal();
+    m_diag_index.resize(N);
+    for (int j = 0; j < N; j++) {
+        m_diag_index[j] = &m_H.coeffRef(j, j) - m_H.valuePtr();
+    }
+}
+
+bool KrylovStepper::sameDynamics(const Stepper& other) const
+{
+    if (!Stepper::sameDynamics(other)) {
+        return false;
+    }
+    const auto& o = static_cast<const KrylovStepper&>(other);
+    if (m_tol != o.m_tol || m_max_dim != o.m_max_dim || !same(imagPot, o.imagPot)) {
+        return false;
+    }
+    // Injected Hamiltonians are arbitrary functions so only the same one counts,
+    // otherwise the potential has been compared and the kinetic part comes from the same grid
+    return m_H_fn == o.m_H_fn;
+}
+
+KrylovStepper& KrylovStepper::setHamiltonian(MatrixFn H)
+{
+    m_H_fn = std::make_shared<const MatrixFn>(std::move(H));
+    m_u = std::numeric_limits<double>::quiet_NaN();
+    return *this;
+}
+
+void KrylovStepper::updateHamiltonian(double u)
+{
+    // NaN never compares equal so the first call always builds
+    if (u == m_u) {
+        return;
+    }
+    m_u = u;
+
+    if (m_H_fn) {
+        m_H = (*m_H_fn)(u);
+        m_H.makeCompressed();
+        if (m_H.rows() != m_psi_f.size() || m_H.cols() != m_psi_f.size()) {
+            S_FATAL("KrylovStepper Hamiltonian is ", m_H.rows(), "x", m_H.cols(), " but the state has dimension ", m_psi_f.size());
+        }
+        return;
+    }
+
+    // Write T_jj + V_j(u) into the stored diagonal
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        m_V_buf = m_V->V();
+        break;
+    case Potential::Type::AMPLITUDE:
+        m_V_buf = u * m_V->V();
+        break;
+    case Potential::Type::SHAKEN:
+        m_V->ShakenV(u, m_V_buf);
+        break;
+    default:
+        m_V_buf = (*m_V)(u);
+        break;
+    }
+    double* values = m_H.valuePtr();
+    for (size_t j = 0; j < m_diag_index.size(); j++) {
+        values[m_diag_index[j]] = m_T_diag[j] + m_V_buf[j];
+    }
+}
+
+void KrylovStepper::applyH(const CVec& q, CVec& w) const
+{
+    w.noalias() = m_H * q;
+}
+
+int KrylovStepper::lanczos(CVec& psi, double tau)
+{
+    const double norm = psi.norm();
+    m_Q.col(0) = psi / norm;
+
+    Eigen::SelfAdjointEigenSolver<RMat> eig;
+    CVec c;
+    for (int j = 0; j < m_max_dim; j++) {
+        applyH(m_Q.col(j), m_w);
+        m_alpha[j] = m_Q.col(j).dot(m_w).real();
+        m_w -= m_alpha[j] * m_Q.col(j);
+        if (j > 0) {
+            m_w -= m_beta[j - 1] * m_Q.col(j - 1);
+        }
+        m_beta[j] = m_w.norm();
+
+        // exp(-i tau T_j) e_1 for the (j+1) x (j+1) tridiagonal T_j
+        const int k = j + 1;
+        eig.computeFromTridiagonal(m_alpha.head(k), m_beta.head(k - 1), Eigen::ComputeEigenvectors);
+        const RMat& S = eig.eigenvectors();
+        c = S * ((-1.0i * tau * eig.eigenvalues().array()).exp() * S.row(0).transpose().array()).matrix();
+
+        // The residual of the next Lanczos vector bounds the error of stopping here
+        // An invariant subspace (beta = 0) is exact
+        if (m_beta[j] * std::abs(c[k - 1]) < m_tol || m_beta[j] < 1e-14 * norm) {
+            psi.noalias() = norm * (m_Q.leftCols(k) * c);
+            return k;
+        }
+        m_Q.col(j + 1) = m_w / m_beta[j];
+    }
+    return 0;
+}
+
+void KrylovStepper::reset(const CVec& psi_0)
+{
+    m_psi_f = psi_0.normalized();
+}
+
+void KrylovStepper::step(double u)
+{
+    updateHamiltonian(u);
+
+    // Double the substeps until every subspace fits in max_dim
+    int dim = 0;
+    while (dim == 0) {
+        m_start = m_psi_f;
+        for (int s = 0; s < m_substeps; s++) {
+            const int k = lanczos(m_psi_f, m_dt / m_substeps);
+            if (k == 0) {
+                dim = 0;
+                m_psi_f = m_start;
+                m_substeps *= 2;
+                break;
+            }
+            dim = std::max(dim, k);
+        }
+    }
+    m_last_dim = std::max(m_last_dim, dim);
+    // Halving the substeps roughly doubles the subspace needed, so try fewer while there is room
+    if (m_substeps > 1 && dim < m_max_dim / 2) {
+        m_substeps /= 2;
+    }
+
+    if (imagPot.size()) {
+        m_psi_f.array() *= imagPot.array();
+    }
+}
+
+void KrylovStepper::evolve(const CVec& psi_0, const RVec& control)
+{
+    reset(psi_0);
+    // Start from scratch so an evaluation doesn't depend on the previous one
+    m_substeps = 1;
+    m_last_dim = 0;
+    for (auto u : control) {
+        step(u);
+    }
+}
+
+int KrylovStepper::subspaceDim() const { return m_last_dim; }
+int KrylovStepper::substeps() const { return m_substeps; }
@@ -8,6 +8,14 @@ RVec Potential::ShakenV(double x0) const
     return spline.resample_shifted(x0);
 }
 
+void Potential::ShakenV(double x0, RVec& out) const
+{
+    spline.resample_shifted(x0, out);
+}
+
+Potential::Type Potential::type() const { return m_type; }
+const RVec& Potential::V() const { return m_V; }
+
 RVec Potential::operator()(double control) const
 {
     switch (m_type) {
@@ -18,12 +26,65 @@ RVec Potential::operator()(double control) const
     case Type::SHAKEN:
         return ShakenV(control);
     case Type::CUSTOM:
-        return m_Vfn(control);
+        return (*m_Vfn)(control);
+    default:
+        S_FATAL("Unknown potential type");
+    };
+}
+
+RVec Potential::derivative(double control) const
+{
+    switch (m_type) {
+    case Type::CONSTANT:
+        return RVec::Zero(m_V.size());
+    case Type::AMPLITUDE:
+        return m_V;
+    case Type::SHAKEN: {
+        RVec dV(m_V.size());
+        spline.resample_shifted_derivative(control, dV);
+        return dV;
+    }
+    case Type::CUSTOM: {
+        const double h = 1e-6 * std::max(1.0, std::abs(control));
+        return ((*m_Vfn)(control + h) - (*m_Vfn)(control - h)) / (2 * h);
+    }
     default:
         S_FATAL("Unknown potential type");
     };
 }
 
+RVec Potential::secondDerivative(double control) const
+{
+    switch (m_type) {
+    case Type::CONSTANT:
+    case Type::AMPLITUDE:
+        return RVec::Zero(m_V.size());
+    case Type::SHAKEN: {
+        RVec d2V(m_V.size());
+        spline.resample_shifted_second_derivative(control, d2V);
+        return d2V;
+    }
+    case Type::CUSTOM: {
+        const double h = 1e-4 * std::max(1.0, std::abs(control));
+        return ((*m_Vfn)(control + h) - 2 * (*m_Vfn)(control) + (*m_Vfn)(control - h)) / (h * h);
+    }
+    default:
+        S_FATAL("Unknown potential type");
+    };
+}
+
+bool Potential::operator==(const Potential& other) const
+{
+    if (m_type != other.m_type) {
+        return false;
+    }
+    // Arbitrary functions can't be compared so only the same one counts
+    if (m_type == Type::CUSTOM) {
+        return m_Vfn == other.m_Vfn;
+    }
+    return m_V.size() == other.m_V.size() && m_V == other.m_V && m_x.size() == other.m_x.size() && m_x == other.m_x;
+}
+
 void Potential::initSpline()
 {
     if (m_type == Type::SHAKEN) {
@@ -0,0 +1,88 @@
+#include "include/Physics/PropagatorTable.hpp"
+#include "include/Physics/Kernels.hpp"
+#include "src/Utils/Logger.hpp"
+
+PropagatorTable::PropagatorTable(double umin, double umax, double tol, size_t max_bytes)
+    : m_umin(umin)
+    , m_umax(umax)
+    , m_tol(tol)
+    , m_max_bytes(max_bytes)
+{
+    if (umax <= umin) {
+        S_FATAL("Invalid control range for the propagator table [", umin, ", ", umax, "]");
+    }
+}
+
+void PropagatorTable::build(const Potential& V, double dt, const RVec& imagPot)
+{
+    std::call_once(m_built, [&]() {
+        const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+        auto exact = [&](double u, std::complex<double>* out) {
+            const RVec Vu = V(u);
+            makePhase(out, Vu.data(), dt, absorber, Vu.size());
+        };
+        const int n = V(m_umin).size();
+
+        // Start coarse and keep adding the midpoints we checked against until we are accurate enough
+        int M = 9;
+        m_table.resize(n, M);
+        for (int j = 0; j < M; j++) {
+            exact(m_umin + j * (m_umax - m_umin) / (M - 1), m_table.col(j).data());
+        }
+        CMat mids(n, M - 1);
+        while (true) {
+            m_du = (m_umax - m_umin) / (M - 1);
+            mids.resize(n, M - 1);
+            m_error = 0;
+            for (int j = 0; j < M - 1; j++) {
+                exact(m_umin + (j + 0.5) * m_du, mids.col(j).data());
+                m_error = std::max(m_error, (0.5 * (m_table.col(j) + m_table.col(j + 1)) - mids.col(j)).cwiseAbs().maxCoeff());
+            }
+            if (m_error <= m_tol) {
+                break;
+            }
+            if ((2 * M - 1) * n * sizeof(std::complex<double>) > m_max_bytes) {
+                S_ERROR("Propagator table can't reach tolerance ", m_tol, " within ", m_max_bytes / 1e6, " MB, using error ", m_error);
+                break;
+            }
+            CMat refined(n, 2 * M - 1);
+            for (int j = 0; j < M - 1; j++) {
+                refined.col(2 * j) = m_table.col(j);
+                refined.col(2 * j + 1) = mids.col(j);
+            }
+            refined.col(2 * M - 2) = m_table.col(M - 1);
+            m_table.swap(refined);
+            M = 2 * M - 1;
+        }
+        S_LOG("Propagator table: ", M, " controls in [", m_umin, ", ", m_umax, "] using ", bytes() / 1e6, " MB with max error ", m_error);
+    });
+}
+
+bool PropagatorTable::contains(double u) const { return u >= m_umin && u <= m_umax; }
+
+void PropagatorTable::locate(double u, int& j, double& w) const
+{
+    const double s = (u - m_umin) / m_du;
+    j = std::min((int)s, (int)m_table.cols() - 2);
+    w = s - j;
+}
+
+void PropagatorTable::apply(CVec& psi, double u) const
+{
+    int j;
+    double w;
+    locate(u, j, w);
+    psi.array() *= (1 - w) * m_table.col(j).array() + w * m_table.col(j + 1).array();
+}
+
+void PropagatorTable::interpolate(double u, CVec& out) const
+{
+    int j;
+    double w;
+    locate(u, j, w);
+    out = (1 - w) * m_table.col(j) + w * m_table.col(j + 1);
+}
+
+int PropagatorTable::size() const { return m_table.cols(); }
+size_t PropagatorTable::bytes() const { return m_table.size() * sizeof(std::complex<double>); }
+double PropagatorTable::error() const { return m_error; }
@@ -102,18 +102,46 @@ namespace tk {
 
 #define seg(name) eigen_##name.segment(idx, n)
     RVec spline::resample_shifted(double x0) const
+    {
+        RVec out(eigen_x.size() / 3);
+        resample_shifted(x0, out);
+        return out;
+    }
+
+    void spline::resample_shifted(double x0, RVec& out) const
     {
         // we want to resample in parallel using eigen's efficient expressions
         // This assumes all points in x are evenly spaced
 
-        static size_t n = eigen_x.size() / 3;
+        const size_t n = eigen_x.size() / 3;
         // find where our minimum x-value translated to
         double h = eigen_x[n] - x0;
         size_t idx = find_closest(h);
         h -= m_x[idx];
 
         static auto fix_eps = [](double val) { return (abs(val) < 1e-16) ? 0. : val; };
-        return RVec((h * (h * (h * seg(d) + seg(c)) + seg(b)) + seg(y)).unaryExpr(fix_eps));
+        out = (h * (h * (h * seg(d) + seg(c)) + seg(b)) + seg(y)).unaryExpr(fix_eps);
+    }
+
+    void spline::resample_shifted_derivative(double x0, RVec& out) const
+    {
+        // Same segments as resample_shifted, with dh/dx0 = -1
+        const size_t n = eigen_x.size() / 3;
+        double h = eigen_x[n] - x0;
+        size_t idx = find_closest(h);
+        h -= m_x[idx];
+
+        out = -(h * (3 * h * seg(d) + 2 * seg(c)) + seg(b));
+    }
+
+    void spline::resample_shifted_second_derivative(double x0, RVec& out) const
+    {
+        const size_t n = eigen_x.size() / 3;
+        double h = eigen_x[n] - x0;
+        size_t idx = find_closest(h);
+        h -= m_x[idx];
+
+        out = 6 * h * seg(d) + 2 * seg(c);
     }
 #undef seg
 namespace internal {
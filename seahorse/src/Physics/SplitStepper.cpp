@@ -1,77 +1,571 @@
 #include "include/Physics/SplitStepper.hpp"
+#include "include/Physics/Kernels.hpp"
+#include "include/Physics/TrajectoryStore.hpp"
 #include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <array>
 
 // Constructor
 SplitStepper::SplitStepper() { }
 
-SplitStepper::SplitStepper(double dt, HamiltonianFn& H, bool use_imag_pot)
+SplitStepper::SplitStepper(double dt, HamiltonianFn& H, bool use_imag_pot, FFT::Backend backend)
     : Stepper(dt, H)
-    , m_V(H.V)
+    , m_dp(H.p[1])
+    , m_fft(H.hs.dim(), backend)
 {
-    m_fft.fwd(m_mombuf, m_psi_f);
-    m_T_exp_2 = (-0.5i * dt * H.T_p.array()).exp();
+    // Unnormalised FFTs scale by N on each fwd/inv round trip so we undo that here
+    const double norm = 1.0 / H.hs.dim();
+    m_T_exp_2 = norm * (-0.5i * dt * H.T_p.array()).exp();
     // m_T_exp = m_T_exp_2.array().square(); uses e^2a = (e^a)^2 to avoid exp again
-    m_T_exp = (-1.0i * dt * H.T_p.array()).exp();
+    m_T_exp = norm * (-1.0i * dt * H.T_p.array()).exp();
+    m_T_back = m_T_exp.conjugate();
+    m_T_back_2 = m_T_exp_2.conjugate();
 
-    // Absorb wavefunction in the outer 1/8ths of the domain
+    // Otherwise we leave the absorber empty so the kernels skip it entirely
     if (use_imag_pot) {
-        RVec imagPotstrength = 100 * (1 - planck_taper(RVec::Ones(H.hs.dim()), 1.0 / 8.0));
-        imagPot = (-m_dt * imagPotstrength.array()).exp();
+        imagPot = (-m_dt * absorber(H.hs).array()).exp();
+    }
+    const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+
+    // Do as much of the potential propagator as we can up front
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        m_V_exp_const.resize(H.hs.dim());
+        makePhase(m_V_exp_const.data(), m_V->V().data(), m_dt, absorber, H.hs.dim());
+        break;
+    case Potential::Type::AMPLITUDE:
+        m_dtV = m_dt * m_V->V();
+        break;
+    case Potential::Type::SHAKEN:
+        m_V_shaken.resize(H.hs.dim());
+        break;
+    case Potential::Type::CUSTOM:
+        break;
+    }
+}
+
+SplitStepper& SplitStepper::setCoMovingFrame(bool co_moving)
+{
+    if (co_moving && m_V->type() != Potential::Type::SHAKEN) {
+        S_FATAL("The co-moving frame is only available for shaken potentials");
+    }
+    m_co_moving = co_moving;
+    // The lattice frame potential propagator is constant
+    if (m_co_moving && m_V_exp_const.size() == 0) {
+        m_V_exp_const.resize(m_V->V().size());
+        makePhase(m_V_exp_const.data(), m_V->V().data(), m_dt, imagPot.size() ? imagPot.data() : nullptr, m_V->V().size());
+    }
+    return *this;
+}
+
+SplitStepper& SplitStepper::setPropagatorTable(double umin, double umax, double tol, size_t max_bytes)
+{
+    m_table = std::make_shared<PropagatorTable>(umin, umax, tol, max_bytes);
+    return *this;
+}
+
+const PropagatorTable* SplitStepper::propagatorTable() const { return m_table.get(); }
+
+bool SplitStepper::sameDynamics(const Stepper& other) const
+{
+    if (!Stepper::sameDynamics(other)) {
+        return false;
+    }
+    const auto& o = static_cast<const SplitStepper&>(other);
+    return same(m_T_exp_2, o.m_T_exp_2) && same(imagPot, o.imagPot) && m_co_moving == o.m_co_moving && m_table == o.m_table;
+}
+
+void SplitStepper::setPrecision(Precision precision)
+{
+    m_precision = precision;
+    if (precision == Precision::SINGLE && m_T_exp_f.size() == 0) {
+        m_T_exp_f = m_T_exp.cast<std::complex<float>>();
+        m_T_exp_2_f = m_T_exp_2.cast<std::complex<float>>();
+        imagPot_f = imagPot.cast<float>();
+        m_V_exp_const_f = m_V_exp_const.cast<std::complex<float>>();
+        m_dtV_f = m_dtV.cast<float>();
+    }
+}
+
+template <Potential::Type type>
+void SplitStepper::applyPotential(CVec& psi, double u)
+{
+    const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+    if constexpr (type == Potential::Type::CONSTANT) {
+        psi.array() *= m_V_exp_const.array();
+    } else if constexpr (type == Potential::Type::AMPLITUDE) {
+        applyPhase(psi.data(), m_dtV.data(), u, absorber, psi.size());
+    } else if constexpr (type == Potential::Type::SHAKEN) {
+        m_V->ShakenV(u, m_V_shaken);
+        applyPhase(psi.data(), m_V_shaken.data(), m_dt, absorber, psi.size());
     } else {
-        imagPot = RVec::Ones(H.hs.dim());
+        // Slow fallback for custom potentials
+        const RVec V = (*m_V)(u);
+        applyPhase(psi.data(), V.data(), m_dt, absorber, psi.size());
     }
 }
 
-void SplitStepper::reset(const CVec& psi_0)
+template <Potential::Type type>
+void SplitStepper::applyPotential(CMat& psis, double u)
 {
-    m_psi_f = psi_0.normalized();
+    const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+    const int n = psis.rows();
+    if constexpr (type == Potential::Type::CONSTANT) {
+        psis.array().colwise() *= m_V_exp_const.array();
+        return;
+    } else if constexpr (type == Potential::Type::AMPLITUDE) {
+        m_V_exp.resize(n);
+        makePhase(m_V_exp.data(), m_dtV.data(), u, absorber, n);
+    } else if constexpr (type == Potential::Type::SHAKEN) {
+        m_V->ShakenV(u, m_V_shaken);
+        m_V_exp.resize(n);
+        makePhase(m_V_exp.data(), m_V_shaken.data(), m_dt, absorber, n);
+    } else {
+        const RVec V = (*m_V)(u);
+        m_V_exp.resize(n);
+        makePhase(m_V_exp.data(), V.data(), m_dt, absorber, n);
+    }
+    psis.array().colwise() *= m_V_exp.array();
 }
 
-void SplitStepper::step(double u) // Move forward a single step
+template <Potential::Type type>
+void SplitStepper::applyPotential(CVecf& psi, double u)
+{
+    const float* absorber = imagPot_f.size() ? imagPot_f.data() : nullptr;
+    if constexpr (type == Potential::Type::CONSTANT) {
+        psi.array() *= m_V_exp_const_f.array();
+    } else if constexpr (type == Potential::Type::AMPLITUDE) {
+        applyPhase(psi.data(), m_dtV_f.data(), u, absorber, psi.size());
+    } else {
+        // V(u) itself is still built in double
+        if constexpr (type == Potential::Type::SHAKEN) {
+            m_V->ShakenV(u, m_V_shaken);
+            m_V_f = m_V_shaken.cast<float>();
+        } else {
+            m_V_f = (*m_V)(u).cast<float>();
+        }
+        applyPhase(psi.data(), m_V_f.data(), m_dt, absorber, psi.size());
+    }
+}
+
+void SplitStepper::applyTabulated(CVec& psi, double u)
+{
+    if (m_table->contains(u)) {
+        m_table->apply(psi, u);
+    } else {
+        applyPotential<Potential::Type::CUSTOM>(psi, u);
+    }
+}
+
+void SplitStepper::applyTabulated(CMat& psis, double u)
+{
+    if (m_table->contains(u)) {
+        m_table->interpolate(u, m_V_exp);
+        psis.array().colwise() *= m_V_exp.array();
+    } else {
+        applyPotential<Potential::Type::CUSTOM>(psis, u);
+    }
+}
+
+// Kinetic propagators for single states and batches
+static inline void applyKinetic(CVec& psi, const CVec& T_exp) { psi.array() *= T_exp.array(); }
+static inline void applyKinetic(CMat& psis, const CVec& T_exp) { psis.array().colwise() *= T_exp.array(); }
+static inline void applyKinetic(CVecf& psi, const CVecf& T_exp) { psi.array() *= T_exp.array(); }
+
+template <typename State>
+const auto& SplitStepper::kinetic() const
 {
-    m_fft.fwd(m_mombuf, m_psi_f);
-    m_mombuf = m_mombuf.array().cwiseProduct(m_T_exp_2.array());
-    m_fft.inv(m_psi_f, m_mombuf);
-    m_psi_f = m_psi_f.array()
-                  .cwiseProduct((-1.0i * m_dt * m_V(u).array()).exp())
-                  .cwiseProduct(imagPot.array());
-    m_fft.fwd(m_mombuf, m_psi_f);
-    m_mombuf = m_mombuf.array().cwiseProduct(m_T_exp_2.array());
-    m_fft.inv(m_psi_f, m_mombuf);
+    if constexpr (std::is_same_v<State, CVecf>) {
+        return m_T_exp_f;
+    } else {
+        return m_T_exp;
+    }
+}
+
+template <typename State>
+const auto& SplitStepper::halfKinetic() const
+{
+    if constexpr (std::is_same_v<State, CVecf>) {
+        return m_T_exp_2_f;
+    } else {
+        return m_T_exp_2;
+    }
 }
 
 // Optimised steps but can't provide intermediate step wavefunctions
 // This combines T/2 ifft fft T/2 between steps to save computation.
-void SplitStepper::evolve(const CVec& psi_0, const RVec& control)
+template <typename State, typename Kick>
+void SplitStepper::propagate(State& psi, const RVec& control, Kick kick)
 {
-    reset(psi_0);
-
-    // Timer timer;
     // Initial half step T/2
-    m_fft.fwd(m_mombuf, m_psi_f);
-    m_mombuf = m_mombuf.array()
-                   .cwiseProduct(m_T_exp_2.array());
+    m_fft.fwd(psi);
+    applyKinetic(psi, halfKinetic<State>());
 
     // Main loop V,T full steps
     for (int i = 0; i < control.size() - 1; i++) {
-        m_fft.inv(m_psi_f, m_mombuf);
-        m_psi_f = m_psi_f.array()
-                      .cwiseProduct((-1.0i * m_dt * m_V(control[i]).array()).exp())
-                      .cwiseProduct(imagPot.array());
-        m_fft.fwd(m_mombuf, m_psi_f);
-        m_mombuf = m_mombuf.array()
-                       .cwiseProduct(m_T_exp.array());
+        m_fft.inv(psi);
+        kick(psi, control[i]);
+        m_fft.fwd(psi);
+        applyKinetic(psi, kinetic<State>());
     }
 
     // Finishing out the last V,T/2
-    m_fft.inv(m_psi_f, m_mombuf);
-    m_psi_f = m_psi_f.array()
-                  .cwiseProduct((-1.0i * m_dt * m_V(control[control.size() - 1]).array()).exp())
-                  .cwiseProduct(imagPot.array());
-    m_fft.fwd(m_mombuf, m_psi_f);
-    m_mombuf = m_mombuf.array()
-                   .cwiseProduct(m_T_exp_2.array());
-    m_fft.inv(m_psi_f, m_mombuf);
+    m_fft.inv(psi);
+    kick(psi, control[control.size() - 1]);
+    m_fft.fwd(psi);
+    applyKinetic(psi, halfKinetic<State>());
+    m_fft.inv(psi);
+}
+
+template <typename State>
+void SplitStepper::propagate(State& psi, const RVec& control)
+{
+    // These are only implemented in double precision
+    if constexpr (!std::is_same_v<State, CVecf>) {
+        if (m_co_moving) {
+            return propagateCoMoving(psi, control);
+        }
+        if (m_table) {
+            m_table->build(*m_V, m_dt, imagPot);
+            return propagate(psi, control, [this](State& psi, double u) { applyTabulated(psi, u); });
+        }
+    }
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        return propagate(psi, control, [this](State& psi, double u) { applyPotential<Potential::Type::CONSTANT>(psi, u); });
+    case Potential::Type::AMPLITUDE:
+        return propagate(psi, control, [this](State& psi, double u) { applyPotential<Potential::Type::AMPLITUDE>(psi, u); });
+    case Potential::Type::SHAKEN:
+        return propagate(psi, control, [this](State& psi, double u) { applyPotential<Potential::Type::SHAKEN>(psi, u); });
+    case Potential::Type::CUSTOM:
+        return propagate(psi, control, [this](State& psi, double u) { applyPotential<Potential::Type::CUSTOM>(psi, u); });
+    default:
+        S_FATAL("Unknown potential type");
+    }
+}
+
+template <typename State>
+void SplitStepper::applyShiftedKinetic(State& psi, const CVec& T_exp, double a)
+{
+    // exp(-i p a) with p = dp * m for m in [0, N/2) then [-N/2, 0)
+    // Split m = k + j into blocks so we only need N/B + B complex exponentials rather than N
+    static constexpr int B = 64;
+    const int n = T_exp.size();
+    const int half = n / 2;
+    const double theta = m_dp * a;
+
+    std::array<std::complex<double>, B> fine;
+    for (int j = 0; j < B; j++) {
+        fine[j] = std::polar(1.0, -theta * j);
+    }
+    const std::complex<double> wrap = std::polar(1.0, theta * half);
+
+    // Single states are multiplied directly, batches share a precomputed propagator
+    constexpr bool single = std::is_same_v<State, CVec>;
+    std::complex<double>* out = single ? psi.data() : nullptr;
+    if constexpr (!single) {
+        m_T_shift.setOnes(n);
+        out = m_T_shift.data();
+    }
+    for (int k = 0; k < half; k += B) {
+        const std::complex<double> coarse = std::polar(1.0, -theta * k);
+        const std::complex<double> coarse_neg = coarse * wrap;
+        const int end = std::min(B, half - k);
+        for (int j = 0; j < end; j++) {
+            out[k + j] *= T_exp[k + j] * (coarse * fine[j]);
+            out[half + k + j] *= T_exp[half + k + j] * (coarse_neg * fine[j]);
+        }
+    }
+    if constexpr (!single) {
+        applyKinetic(psi, m_T_shift);
+    }
+}
+
+// With S(a) the translation by a, V(x - u) = S(u) V(x) S(-u) and S commutes with T
+// so the lab frame T/2 V(u_n) T ... T V(u_0) T/2 becomes S(u_n) T/2 V T S(u_{n-1} - u_n) ... V T/2 S(-u_0)
+template <typename State>
+void SplitStepper::propagateCoMoving(State& psi, const RVec& control)
+{
+    const int n = control.size();
+
+    // Initial half step T/2 and move into the lattice frame
+    m_fft.fwd(psi);
+    applyShiftedKinetic(psi, m_T_exp_2, -control[0]);
 
+    // Main loop V,T full steps with the lattice moving u_i -> u_{i+1}
+    for (int i = 0; i < n - 1; i++) {
+        m_fft.inv(psi);
+        applyPotential<Potential::Type::CONSTANT>(psi, control[i]);
+        m_fft.fwd(psi);
+        applyShiftedKinetic(psi, m_T_exp, control[i] - control[i + 1]);
+    }
+
+    // Finishing out the last V,T/2 and back to the lab frame
+    m_fft.inv(psi);
+    applyPotential<Potential::Type::CONSTANT>(psi, control[n - 1]);
+    m_fft.fwd(psi);
+    applyShiftedKinetic(psi, m_T_exp_2, control[n - 1]);
+    m_fft.inv(psi);
+}
+
+void SplitStepper::reset(const CVec& psi_0)
+{
+    m_psi_f = psi_0.normalized();
+}
+
+void SplitStepper::step(double u) // Move forward a single step
+{
+    // A single step is just the fused loop over one control value
+    propagate(m_psi_f, RVec::Constant(1, u));
+}
+
+void SplitStepper::stepBack(double u)
+{
+    if (imagPot.size()) {
+        S_FATAL("Can't step back through the absorbing boundary, use use_imag_pot = false");
+    }
+    // Time reversal: V is real and T(p) = T(-p) so conjugating turns exp(-i dt H) into exp(i dt H)
+    m_psi_f = m_psi_f.conjugate();
+    step(u);
+    m_psi_f = m_psi_f.conjugate();
+}
+
+void SplitStepper::evolve(const CVec& psi_0, const RVec& control)
+{
+    reset(psi_0);
+
+    // Timer timer;
+    if (m_precision == Precision::SINGLE && !m_co_moving && !m_table) {
+        m_psi_single = m_psi_f.cast<std::complex<float>>();
+        propagate(m_psi_single, control);
+        m_psi_f = m_psi_single.cast<std::complex<double>>();
+    } else {
+        propagate(m_psi_f, control);
+    }
     //S_LOG("Stepped ", control.size(), " times in ", timer.Elapsed(), " seconds");
-}
\ No newline at end of file
+}
+
+void SplitStepper::propagateState(const RVec& control)
+{
+    propagate(m_psi_f, control);
+}
+
+// Same scheme as evolve, but every column shares the potential propagator
+void SplitStepper::evolveBatch(const CMat& psi_0s, const RVec& control)
+{
+    m_psis_f = psi_0s.colwise().normalized();
+    propagate(m_psis_f, control);
+    m_psi_f = m_psis_f.col(0);
+}
+
+const RVec& SplitStepper::potential(double u)
+{
+    switch (m_V->type()) {
+    case Potential::Type::CONSTANT:
+        return m_V->V();
+    case Potential::Type::AMPLITUDE:
+        m_V_u = u * m_V->V();
+        break;
+    case Potential::Type::SHAKEN:
+        m_V_u.resize(m_V->V().size());
+        m_V->ShakenV(u, m_V_u);
+        break;
+    case Potential::Type::CUSTOM:
+        m_V_u = (*m_V)(u);
+        break;
+    }
+    return m_V_u;
+}
+
+template <typename State>
+void SplitStepper::applyKineticFFT(State& psi, const CVec& T_exp)
+{
+    m_fft.fwd(psi);
+    applyKinetic(psi, T_exp);
+    m_fft.inv(psi);
+}
+
+// Multiply every column by absorber * exp(-i scale V)
+static inline void applyPhase(CMat& psis, const RVec& V, double scale, const double* absorber)
+{
+    for (int k = 0; k < psis.cols(); k++) {
+        applyPhase(psis.col(k).data(), V.data(), scale, absorber, psis.rows());
+    }
+}
+
+CVec SplitStepper::overlapGradient(const CVec& psi_0, const CVec& psi_t, const RVec& control, TrajectoryStore& store, std::complex<double>& tau)
+{
+    const int n = control.size();
+    const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+    CVec grad(n);
+    // The store holds xi_i = K psi_i
+    CVec xi_0 = psi_0.normalized();
+    applyKineticFFT(xi_0, m_T_exp_2);
+    // zeta holds K^dagger chi_{i+1} when visiting xi_i
+    CVec zeta, phi;
+
+    // xi_{i+1} = T A P xi_i
+    auto advance = [&](CVec& xi, int i) {
+        applyPhase(xi.data(), potential(control[i]).data(), m_dt, absorber, xi.size());
+        applyKineticFFT(xi, m_T_exp);
+    };
+    // xi_i = P^dagger T^dagger xi_{i+1}
+    auto retreat = [&](CVec& xi, int i) {
+        if (absorber) {
+            S_FATAL("Can't step back through the absorbing boundary, use use_imag_pot = false");
+        }
+        applyKineticFFT(xi, m_T_back);
+        applyPhase(xi.data(), potential(control[i]).data(), -m_dt, nullptr, xi.size());
+    };
+    auto visit = [&](const CVec& xi, int i) {
+        if (i == n) {
+            m_psi_f = xi;
+            applyKineticFFT(m_psi_f, m_T_back_2);
+            tau = overlap(psi_t, m_psi_f);
+            // overlap doesn't conjugate psi_t so as a bra the co-state is its conjugate
+            zeta = psi_t.conjugate();
+            applyKineticFFT(zeta, m_T_back_2);
+            return;
+        }
+        const RVec& V = potential(control[i]);
+        const RVec dV = m_V->derivative(control[i]);
+
+        // <A K^dagger chi_{i+1}| (-i dt V') P K psi_i> = <zeta| (-i dt V') A P xi_i>
+        phi = xi;
+        applyPhase(phi.data(), V.data(), m_dt, absorber, phi.size());
+        grad[i] = -1.0i * m_dt * zeta.dot(dV.cwiseProduct(phi));
+
+        // K^dagger chi_i = T^dagger P^dagger A zeta
+        applyPhase(zeta.data(), V.data(), -m_dt, absorber, zeta.size());
+        applyKineticFFT(zeta, m_T_back);
+    };
+
+    store.reverse(xi_0, n, advance, visit, retreat);
+    return grad;
+}
+
+CVec SplitStepper::overlapHessianProduct(const CVec& psi_0, const CVec& psi_t, const RVec& control, const RVec& v, TrajectoryStore& store, std::complex<double>& tau, CVec& grad)
+{
+    const int n = control.size();
+    const int N = psi_0.size();
+    const double* absorber = imagPot.size() ? imagPot.data() : nullptr;
+    CVec Hv(n);
+    grad.resize(n);
+    // The store holds each xi_i = K psi_i with its tangent along v as [xi_i; D xi_i]
+    CVec xi = psi_0.normalized();
+    applyKineticFFT(xi, m_T_exp_2);
+    CVec pair = CVec::Zero(2 * N);
+    pair.head(N) = xi;
+    // Buffers for advance/retreat
+    CVec dxi;
+    // zeta and dzeta hold K^dagger chi_{i+1} and its tangent when visiting xi_i
+    CVec zeta, dzeta, phi, dphi;
+
+    auto advance = [&](CVec& state, int i) {
+        const RVec& V = potential(control[i]);
+        const RVec dV = m_V->derivative(control[i]);
+        xi = state.head(N);
+        dxi = state.tail(N);
+        applyPhase(xi.data(), V.data(), m_dt, absorber, N);
+        applyPhase(dxi.data(), V.data(), m_dt, absorber, N);
+        // D xi_{i+1} = T (A P D xi_i + v_i (-i dt V') A P xi_i)
+        dxi -= (1.0i * m_dt * v[i]) * dV.cwiseProduct(xi);
+        applyKineticFFT(xi, m_T_exp);
+        applyKineticFFT(dxi, m_T_exp);
+        state << xi, dxi;
+    };
+    auto retreat = [&](CVec& state, int i) {
+        if (absorber) {
+            S_FATAL("Can't step back through the absorbing boundary, use use_imag_pot = false");
+        }
+        const RVec& V = potential(control[i]);
+        xi = state.head(N);
+        dxi = state.tail(N);
+        applyKineticFFT(xi, m_T_back);
+        applyKineticFFT(dxi, m_T_back);
+        applyPhase(xi.data(), V.data(), -m_dt, nullptr, N);
+        applyPhase(dxi.data(), V.data(), -m_dt, nullptr, N);
+        // D xi_i = P^dagger T^dagger D xi_{i+1} - v_i (-i dt V') xi_i
+        dxi += (1.0i * m_dt * v[i]) * m_V->derivative(control[i]).cwiseProduct(xi);
+        state << xi, dxi;
+    };
+    auto visit = [&](const CVec& state, int i) {
+        if (i == n) {
+            m_psi_f = state.head(N);
+            applyKineticFFT(m_psi_f, m_T_back_2);
+            tau = overlap(psi_t, m_psi_f);
+            zeta = psi_t.conjugate();
+            applyKineticFFT(zeta, m_T_back_2);
+            dzeta = CVec::Zero(N);
+            return;
+        }
+        const RVec& V = potential(control[i]);
+        const RVec dV = m_V->derivative(control[i]);
+        const RVec d2V = m_V->secondDerivative(control[i]);
+
+        // phi = A P xi_i and its tangent, the absorber is real so it moves across from the co-state
+        phi = state.head(N);
+        dphi = state.tail(N);
+        applyPhase(phi.data(), V.data(), m_dt, absorber, N);
+        applyPhase(dphi.data(), V.data(), m_dt, absorber, N);
+
+        // S'_i = K A (-i dt V') P K and S''_i = K A (-i dt V'' - dt^2 V'^2) P K
+        const CVec dVphi = dV.cwiseProduct(phi);
+        grad[i] = -1.0i * m_dt * zeta.dot(dVphi);
+        Hv[i] = -1.0i * m_dt * (dzeta.dot(dVphi) + zeta.dot(dV.cwiseProduct(dphi)))
+            + v[i] * (-1.0i * m_dt * zeta.dot(d2V.cwiseProduct(phi)) - m_dt * m_dt * zeta.dot(dV.cwiseAbs2().cwiseProduct(phi)));
+
+        // K^dagger chi_i = T^dagger P^dagger A zeta
+        // K^dagger D chi_i = T^dagger P^dagger (A dzeta + v_i (i dt V') A zeta)
+        applyPhase(zeta.data(), V.data(), -m_dt, absorber, N);
+        applyPhase(dzeta.data(), V.data(), -m_dt, absorber, N);
+        dzeta += (1.0i * m_dt * v[i]) * dV.cwiseProduct(zeta);
+        applyKineticFFT(zeta, m_T_back);
+        applyKineticFFT(dzeta, m_T_back);
+    };
+
+    store.reverse(pair, n, advance, visit, retreat);
+    return Hv;
+}
+
+void SplitStepper::enterBlock(CMat& psis, bool adjoint) { applyKineticFFT(psis, adjoint ? m_T_back_2 : m_T_exp_2); }
+void SplitStepper::leaveBlock(CMat& psis, bool adjoint) { applyKineticFFT(psis, adjoint ? m_T_exp_2 : m_T_back_2); }
+
+void SplitStepper::stepBlock(CMat& xis, double u)
+{
+    // K psi <- K S psi = T A P (K psi)
+    applyPhase(xis, potential(u), m_dt, imagPot.size() ? imagPot.data() : nullptr);
+    applyKineticFFT(xis, m_T_exp);
+}
+
+void SplitStepper::adjointStep(CMat& zetas, double u)
+{
+    // K^dagger chi <- K^dagger S^dagger chi = T^dagger P^dagger A (K^dagger chi)
+    applyPhase(zetas, potential(u), -m_dt, imagPot.size() ? imagPot.data() : nullptr);
+    applyKineticFFT(zetas, m_T_back);
+}
+
+void SplitStepper::adjointStepBack(CMat& zetas, double u)
+{
+    if (imagPot.size()) {
+        S_FATAL("Can't step back through the absorbing boundary, use use_imag_pot = false");
+    }
+    applyKineticFFT(zetas, m_T_exp);
+    applyPhase(zetas, potential(u), m_dt, nullptr);
+}
+
+std::complex<double> SplitStepper::stepDerivative(const CMat& zetas, const CMat& xis, double u)
+{
+    // <A K^dagger chi| (-i dt V') P K |psi> = <zeta| (-i dt V') A P |xi>, the same weight for every column
+    const RVec& V = potential(u);
+    m_V_exp.resize(V.size());
+    makePhase(m_V_exp.data(), V.data(), m_dt, imagPot.size() ? imagPot.data() : nullptr, V.size());
+    m_V_exp.array() *= m_V->derivative(u).array();
+
+    std::complex<double> d = 0;
+    for (int k = 0; k < xis.cols(); k++) {
+        d += zetas.col(k).dot(m_V_exp.cwiseProduct(xis.col(k)));
+    }
+    return -1.0i * m_dt * d;
+}
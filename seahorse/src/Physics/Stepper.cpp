@@ -1,4 +1,8 @@
 #include "include/Physics/Stepper.hpp"
+#include "src/Physics/Vectors.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <typeinfo>
 
 // Constructor
 Stepper::Stepper() { }
@@ -6,12 +10,65 @@ Stepper::Stepper(double dt, HamiltonianFn& H)
     : m_dt(dt)
     , m_dx(H.hs.dx())
     , m_psi_f(CVec::Zero(H.hs.dim()))
+    , m_V(std::make_shared<const Potential>(H.V))
+{
+}
+
+RVec Stepper::absorber(const HilbertSpace& hs)
 {
+    return 100 * (1 - planck_taper(RVec::Ones(hs.dim()), 1.0 / 8.0));
 }
 
 std::unique_ptr<Stepper> Stepper::clone() const { return std::unique_ptr<Stepper>(this->clone_impl()); }
 
-CVec Stepper::state() const { return m_psi_f; }
+void Stepper::evolveBatch(const CMat& psi_0s, const RVec& control)
+{
+    m_psis_f.resize(psi_0s.rows(), psi_0s.cols());
+    for (int j = 0; j < psi_0s.cols(); j++) {
+        evolve(psi_0s.col(j), control);
+        m_psis_f.col(j) = m_psi_f;
+    }
+}
+
+bool Stepper::sameDynamics(const Stepper& other) const
+{
+    if (typeid(*this) != typeid(other) || m_dt != other.m_dt || m_dx != other.m_dx || m_psi_f.size() != other.m_psi_f.size()) {
+        return false;
+    }
+    return m_V == other.m_V || (m_V && other.m_V && *m_V == *other.m_V);
+}
+
+void Stepper::setPrecision(Precision precision) { m_precision = precision; }
+Stepper::Precision Stepper::precision() const { return m_precision; }
+
+void Stepper::stepBack(double)
+{
+    S_FATAL("This stepper can't step backwards");
+}
+
+CVec Stepper::overlapGradient(const CVec&, const CVec&, const RVec&, TrajectoryStore&, std::complex<double>&)
+{
+    S_FATAL("This stepper doesn't provide gradients");
+}
+
+CVec Stepper::overlapHessianProduct(const CVec&, const CVec&, const RVec&, const RVec&, TrajectoryStore&, std::complex<double>&, CVec&)
+{
+    S_FATAL("This stepper doesn't provide Hessian products");
+}
+
+// Plain states by default
+void Stepper::enterBlock(CMat&, bool) { }
+void Stepper::leaveBlock(CMat&, bool) { }
+void Stepper::stepBlock(CMat&, double) { S_FATAL("This stepper doesn't provide block steps"); }
+void Stepper::adjointStep(CMat&, double) { S_FATAL("This stepper doesn't provide block steps"); }
+void Stepper::adjointStepBack(CMat&, double) { S_FATAL("This stepper doesn't provide block steps"); }
+std::complex<double> Stepper::stepDerivative(const CMat&, const CMat&, double)
+{
+    S_FATAL("This stepper doesn't provide block steps");
+}
 
+void Stepper::setState(const CVec& psi) { m_psi_f = psi; }
+CVec Stepper::state() const { return m_psi_f; }
+CMat Stepper::states() const { return m_psis_f; }
 double Stepper::dt() const { return m_dt; }
 double Stepper::dx() const { return m_dx; }
@@ -0,0 +1,281 @@
+#include "include/Physics/TrajectoryFile.hpp"
+#include "src/Utils/Logger.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char MAGIC[8] = { 'S', 'H', 'T', 'R', 'A', 'J', '\0', '\0' };
+constexpr uint32_t VERSION = 1;
+
+size_t scalarBytes(TrajectoryFormat format)
+{
+    switch (format) {
+    case TrajectoryFormat::DOUBLE:
+        return sizeof(double);
+    case TrajectoryFormat::SINGLE:
+        return sizeof(float);
+    case TrajectoryFormat::HALF:
+        return sizeof(uint16_t);
+    }
+    S_FATAL("Unknown trajectory format");
+}
+
+// Round to nearest even, done by hand as F16C isn't guaranteed
+uint16_t toHalf(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    const uint32_t sign = (x >> 16) & 0x8000;
+    const int exponent = (int)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffff;
+
+    if (((x >> 23) & 0xff) == 0xff) { // inf / nan
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    }
+    if (exponent >= 31) { // overflow
+        return sign | 0x7c00;
+    }
+    if (exponent <= 0) { // subnormal or zero
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        uint32_t h = mantissa >> shift;
+        const uint32_t rem = mantissa & ((1u << shift) - 1), half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) {
+            h++;
+        }
+        return sign | h;
+    }
+    uint32_t h = (exponent << 10) | (mantissa >> 13);
+    const uint32_t rem = mantissa & 0x1fff;
+    // A carry out of the mantissa correctly bumps the exponent
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) {
+        h++;
+    }
+    return sign | h;
+}
+
+float fromHalf(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+    uint32_t x;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            x = sign;
+        } else { // subnormal, normalise it
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            x = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    } else if (exponent == 31) {
+        x = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        x = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+} // namespace
+
+TrajectoryWriter::TrajectoryWriter(const std::string& filename, int dim, double dt, TrajectoryFormat format, int stride, size_t chunk_bytes)
+    : m_file(filename, std::ios::binary | std::ios::trunc)
+{
+    if (!m_file.is_open()) {
+        S_FATAL("Could not open file: ", filename);
+    }
+    if (stride < 1) {
+        S_FATAL("Trajectory stride must be at least 1, got ", stride);
+    }
+    std::memset(&m_header, 0, sizeof(m_header));
+    std::memcpy(m_header.magic, MAGIC, sizeof(MAGIC));
+    m_header.version = VERSION;
+    m_header.format = format;
+    m_header.dim = dim;
+    m_header.stride = stride;
+    m_header.dt = dt * stride;
+
+    m_state_bytes = 2 * dim * scalarBytes(format);
+    m_chunk_states = std::max<size_t>(1, chunk_bytes / m_state_bytes);
+    m_chunk.resize(m_chunk_states * m_state_bytes);
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+}
+
+TrajectoryWriter::~TrajectoryWriter() { close(); }
+
+void TrajectoryWriter::push(const CVec& psi)
+{
+    if (psi.size() != (Eigen::Index)m_header.dim) {
+        S_FATAL("Trajectory state has size ", psi.size(), " but the file has dim ", m_header.dim);
+    }
+    if (m_pushed++ % m_header.stride != 0) {
+        return;
+    }
+
+    char* out = m_chunk.data() + m_buffered * m_state_bytes;
+    const double* in = reinterpret_cast<const double*>(psi.data());
+    const size_t n = 2 * m_header.dim;
+    switch (m_header.format) {
+    case TrajectoryFormat::DOUBLE:
+        std::memcpy(out, in, m_state_bytes);
+        break;
+    case TrajectoryFormat::SINGLE:
+        for (size_t k = 0; k < n; k++) {
+            reinterpret_cast<float*>(out)[k] = (float)in[k];
+        }
+        break;
+    case TrajectoryFormat::HALF:
+        for (size_t k = 0; k < n; k++) {
+            reinterpret_cast<uint16_t*>(out)[k] = toHalf((float)in[k]);
+        }
+        break;
+    }
+    if (++m_buffered == m_chunk_states) {
+        flush();
+    }
+}
+
+void TrajectoryWriter::flush()
+{
+    if (m_buffered == 0) {
+        return;
+    }
+    m_file.write(m_chunk.data(), m_buffered * m_state_bytes);
+    m_header.count += m_buffered;
+    m_buffered = 0;
+
+    // Keep the count current so a partially written file is still readable
+    m_file.seekp(offsetof(TrajectoryHeader, count));
+    m_file.write(reinterpret_cast<const char*>(&m_header.count), sizeof(m_header.count));
+    m_file.seekp(0, std::ios::end);
+    m_file.flush();
+}
+
+void TrajectoryWriter::record(Stepper& stepper, const CVec& psi_0, const RVec& control)
+{
+    stepper.reset(psi_0);
+    push(stepper.state());
+    for (auto u : control) {
+        stepper.step(u);
+        push(stepper.state());
+    }
+}
+
+void TrajectoryWriter::close()
+{
+    if (!m_file.is_open()) {
+        return;
+    }
+    flush();
+    m_file.close();
+}
+
+int TrajectoryWriter::count() const { return m_header.count + m_buffered; }
+
+TrajectoryReader::TrajectoryReader(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        S_FATAL("Could not open file: ", filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        S_FATAL("Could not stat file: ", filename);
+    }
+    m_bytes = st.st_size;
+    if (m_bytes < sizeof(TrajectoryHeader)) {
+        close(fd);
+        S_FATAL("Not a trajectory file: ", filename);
+    }
+    void* data = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        S_FATAL("Could not map file: ", filename);
+    }
+    m_data = static_cast<const char*>(data);
+
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if (std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) != 0 || m_header.version != VERSION) {
+        S_FATAL("Not a trajectory file (or an unsupported version): ", filename);
+    }
+    m_state_bytes = 2 * m_header.dim * scalarBytes(m_header.format);
+    if (m_state_bytes == 0) {
+        S_FATAL("Trajectory file has no state dimension: ", filename);
+    }
+    // Trust the data on disk over the header count if a writer is still running
+    m_count = std::min<size_t>(m_header.count, (m_bytes - sizeof(TrajectoryHeader)) / m_state_bytes);
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+    if (m_data) {
+        munmap(const_cast<char*>(m_data), m_bytes);
+    }
+}
+
+const char* TrajectoryReader::raw(int i) const
+{
+    if (i < 0 || i >= m_count) {
+        S_FATAL("Trajectory state ", i, " out of range [0, ", m_count, ")");
+    }
+    return m_data + sizeof(TrajectoryHeader) + i * m_state_bytes;
+}
+
+CVec TrajectoryReader::state(int i) const
+{
+    switch (m_header.format) {
+    case TrajectoryFormat::DOUBLE:
+        return map(i);
+    case TrajectoryFormat::SINGLE:
+        return mapf(i).cast<std::complex<double>>();
+    case TrajectoryFormat::HALF:
+        break;
+    }
+    const uint16_t* in = reinterpret_cast<const uint16_t*>(raw(i));
+    CVec psi(m_header.dim);
+    for (Eigen::Index k = 0; k < psi.size(); k++) {
+        psi[k] = { fromHalf(in[2 * k]), fromHalf(in[2 * k + 1]) };
+    }
+    return psi;
+}
+
+Eigen::Map<const CVec> TrajectoryReader::map(int i) const
+{
+    if (m_header.format != TrajectoryFormat::DOUBLE) {
+        S_FATAL("Only DOUBLE trajectories can be mapped as CVec, use state(i)");
+    }
+    return Eigen::Map<const CVec>(reinterpret_cast<const std::complex<double>*>(raw(i)), m_header.dim);
+}
+
+Eigen::Map<const CVecf> TrajectoryReader::mapf(int i) const
+{
+    if (m_header.format != TrajectoryFormat::SINGLE) {
+        S_FATAL("Only SINGLE trajectories can be mapped as CVecf, use state(i)");
+    }
+    return Eigen::Map<const CVecf>(reinterpret_cast<const std::complex<float>*>(raw(i)), m_header.dim);
+}
+
+Eigen::Map<const CMat> TrajectoryReader::states() const
+{
+    if (m_header.format != TrajectoryFormat::DOUBLE) {
+        S_FATAL("Only DOUBLE trajectories can be mapped as CMat, use state(i)");
+    }
+    return Eigen::Map<const CMat>(reinterpret_cast<const std::complex<double>*>(m_data + sizeof(TrajectoryHeader)), m_header.dim, m_count);
+}
+
+int TrajectoryReader::size() const { return m_count; }
+int TrajectoryReader::dim() const { return m_header.dim; }
+int TrajectoryReader::stride() const { return m_header.stride; }
+double TrajectoryReader::dt() const { return m_header.dt; }
+TrajectoryFormat TrajectoryReader::format() const { return m_header.format; }
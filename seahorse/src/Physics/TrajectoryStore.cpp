@@ -0,0 +1,149 @@
+#include "include/Physics/TrajectoryStore.hpp"
+#include "src/Utils/Logger.hpp"
+
+TrajectoryStore::TrajectoryStore(size_t budget_bytes)
+    : m_budget(budget_bytes)
+{
+}
+
+TrajectoryStore& TrajectoryStore::setMode(Mode mode)
+{
+    m_mode = mode;
+    return *this;
+}
+
+double TrajectoryStore::beta(int s, int t)
+{
+    // C(s + t, s) built up term by term, in double as it quickly overflows an int
+    double b = 1;
+    for (int k = 1; k <= s; k++) {
+        b = b * (t + k) / k;
+    }
+    return b;
+}
+
+void TrajectoryStore::reverse(int a, int b, int free, const CVec& psi_a)
+{
+    // The part before each checkpoint is handled by the next pass of the loop rather than recursing,
+    // so the recursion only goes as deep as the checkpoints held at once
+    while (b > a) {
+        const int length = b - a;
+
+        // Enough checkpoints to hold every state, one sweep and then read them back
+        if (free >= length - 1) {
+            m_work = psi_a;
+            for (int k = a; k < b; k++) {
+                m_advance(m_work, k);
+                m_advances++;
+                if (k + 1 < b) {
+                    m_slots[m_used + k - a] = m_work;
+                }
+            }
+            m_visit(m_work, b);
+            for (int j = b - 1; j > a; j--) {
+                m_visit(m_slots[m_used + j - a - 1], j);
+            }
+            return;
+        }
+
+        // Without any checkpoints left we recompute every state from a
+        if (free == 0) {
+            for (int j = b; j > a; j--) {
+                m_work = psi_a;
+                for (int k = a; k < j; k++) {
+                    m_advance(m_work, k);
+                    m_advances++;
+                }
+                m_visit(m_work, j);
+            }
+            return;
+        }
+
+        // Fewest forward sweeps that can cover this segment
+        int t = 1;
+        while (beta(free, t) < length) {
+            t++;
+        }
+        // The part after the checkpoint is reversed with one checkpoint fewer, the part before with one sweep fewer
+        // beta(s, t) = beta(s - 1, t) + beta(s, t - 1) so any split within those limits is optimal,
+        // making the part before as long as possible keeps the recursion into the part after shallow
+        const int after = std::max(1, length - (int)std::min(beta(free, t - 1), (double)length));
+        const int m = b - after;
+
+        CVec& checkpoint = m_slots[m_used++];
+        checkpoint = psi_a;
+        for (int k = a; k < m; k++) {
+            m_advance(checkpoint, k);
+            m_advances++;
+        }
+        reverse(m, b, free - 1, checkpoint);
+        m_visit(checkpoint, m);
+        m_used--;
+
+        b = m - 1;
+    }
+}
+
+void TrajectoryStore::reverse(const CVec& psi_0, int n, StepFn advance, VisitFn visit, StepFn retreat)
+{
+    m_advances = 0;
+    m_retreats = 0;
+    m_psi_0 = psi_0;
+
+    if (m_mode == Mode::REVERSIBLE) {
+        if (!retreat) {
+            S_FATAL("A reversible TrajectoryStore needs a retreat function");
+        }
+        m_slots.clear();
+        m_work = psi_0;
+        for (int i = 0; i < n; i++) {
+            advance(m_work, i);
+            m_advances++;
+        }
+        visit(m_work, n);
+        for (int i = n - 1; i >= 0; i--) {
+            retreat(m_work, i);
+            m_retreats++;
+            visit(m_work, i);
+        }
+        return;
+    }
+
+    // psi_0 and the working state are always held, the rest of the budget goes on checkpoints
+    const size_t state_bytes = psi_0.size() * sizeof(std::complex<double>);
+    const int slots = std::max(0, (int)(m_budget / state_bytes) - 2);
+    if (slots == 0) {
+        S_ERROR("TrajectoryStore budget of ", m_budget, " bytes holds no checkpoints, reversing will take O(n^2) steps");
+    }
+    m_slots.assign(std::min(slots, n), CVec(psi_0.size()));
+    m_used = 0;
+    m_advance = advance;
+    m_visit = visit;
+
+    if (n > 0) {
+        reverse(0, n, m_slots.size(), m_psi_0);
+    }
+    visit(m_psi_0, 0);
+}
+
+TrajectoryStore::StepFn TrajectoryStore::advancer(Stepper& stepper, const RVec& control)
+{
+    return [&stepper, &control](CVec& psi, int i) {
+        stepper.setState(psi);
+        stepper.step(control[i]);
+        psi = stepper.state();
+    };
+}
+
+TrajectoryStore::StepFn TrajectoryStore::retreater(Stepper& stepper, const RVec& control)
+{
+    return [&stepper, &control](CVec& psi, int i) {
+        stepper.setState(psi);
+        stepper.stepBack(control[i]);
+        psi = stepper.state();
+    };
+}
+
+int TrajectoryStore::advances() const { return m_advances; }
+int TrajectoryStore::retreats() const { return m_retreats; }
+int TrajectoryStore::checkpoints() const { return m_slots.size(); }
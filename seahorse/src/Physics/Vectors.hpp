@@ -23,6 +23,9 @@ using RVec = Eigen::VectorXd;
 using CVec = Eigen::VectorXcd;
 using RMat = Eigen::MatrixXd;
 using CMat = Eigen::MatrixXcd;
+// Single precision, only used for cheap screening propagations
+using RVecf = Eigen::VectorXf;
+using CVecf = Eigen::VectorXcf;
 
 // Allow maths style notation on real/complex Vecs + Scalars
 // We promote the type to complex only where needed
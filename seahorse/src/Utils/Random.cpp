@@ -1,4 +1,5 @@
 #include "include/Utils/Random.hpp"
+#include <thread>
 
 uint64_t get_rand_seed()
 {
@@ -11,7 +12,8 @@ uint64_t get_rand_seed()
 randGen::randGen(double start, double stop)
     : dist(std::uniform_real_distribution<double>(start, stop))
 {
-    gen = std::mt19937_64(get_rand_seed());
+    // Mix in the thread id so generators created at the same time differ
+    gen = std::mt19937_64(get_rand_seed() ^ std::hash<std::thread::id> {}(std::this_thread::get_id()));
 }
 
 randGen::randGen()
@@ -21,4 +23,4 @@ randGen::randGen()
 
 double randGen::operator()() { return dist(gen); }
 
-randGen rands = randGen(0.0, 1.0);
+thread_local randGen rands = randGen(0.0, 1.0);